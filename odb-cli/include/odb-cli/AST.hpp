@@ -5,6 +5,9 @@
 namespace odb::ast {
 class Block;
 }
+namespace odb::cmd {
+class CommandMatcher;
+}
 
 bool initCommandMatcher(const std::vector<std::string>& args);
 bool parseDBA(const std::vector<std::string>& args);
@@ -15,3 +18,4 @@ ActionHandler parseDBPro(const std::vector<std::string>& args);
 ActionHandler autoDetectInput(const std::vector<std::string>& args);
 
 const odb::ast::Block* getAST();
+const odb::cmd::CommandMatcher& getCommandMatcher();
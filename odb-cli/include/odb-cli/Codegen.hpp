@@ -1,9 +1,45 @@
 #pragma once
 
+#include "odb-compiler/ir/Codegen.hpp"
+#include <optional>
 #include <string>
 #include <vector>
 
+namespace odb::ast {
+class Block;
+}
+
+/*!
+ * Settings of the codegen section. The command line fills in one instance,
+ * the compile server one for each request.
+ */
+struct CodegenOptions
+{
+    odb::ir::OutputType outputType = odb::ir::OutputType::ObjectFile;
+    bool outputIsExecutable = true;
+    odb::ir::OptimizationLevel optimizationLevel = odb::ir::OptimizationLevel::O0;
+    std::optional<odb::ir::TargetTriple::Arch> arch;
+    std::optional<odb::ir::TargetTriple::Platform> platform;
+};
+
 bool setOutputType(const std::vector<std::string>& args);
+bool setOptimizationLevel(const std::vector<std::string>& args);
 bool setArch(const std::vector<std::string>& args);
 bool setPlatform(const std::vector<std::string>& args);
 bool output(const std::vector<std::string>& args);
+bool run(const std::vector<std::string>& args);
+
+bool parseOutputType(const std::string& str, CodegenOptions* options);
+bool parseOptimizationLevel(const std::string& str, CodegenOptions* options);
+bool parseArch(const std::string& str, CodegenOptions* options);
+bool parsePlatform(const std::string& str, CodegenOptions* options);
+
+/*!
+ * Runs semantic checks on the AST, generates code and links it if an
+ * executable was requested. Writes to stdout if outputName is "-". If the
+ * target is Windows, ".exe" is appended to outputName if necessary.
+ * @param[in] targetMachines If not null, target machines are reused from
+ * this cache.
+ */
+bool generateOutput(const odb::ast::Block* ast, const CodegenOptions& options, std::string& outputName,
+                    odb::ir::TargetMachineCache* targetMachines);
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+bool enableTimeReport(const std::vector<std::string>& args);
+bool setTraceOutput(const std::vector<std::string>& args);
+bool enableMemReport(const std::vector<std::string>& args);
+bool setMemReportJSONOutput(const std::vector<std::string>& args);
+
+/*!
+ * Prints or writes every report that was requested on the command line.
+ * Called once all actions have run, whether they succeeded or not.
+ */
+bool writeReports();
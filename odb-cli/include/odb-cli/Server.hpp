@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+bool setServerJobs(const std::vector<std::string>& args);
+bool runServer(const std::vector<std::string>& args);
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Messages exchanged between odbc --server and odbc_client over a unix
+ * domain socket. The client sends one request per connection and the server
+ * answers with one response before closing it.
+ *
+ * Each message starts with a magic number and a version, followed by its
+ * fields in the order they are declared below. Strings are a 32-bit little
+ * endian length followed by the bytes.
+ */
+
+struct CompileRequest
+{
+    //! Same values as --output-type
+    std::string outputType = "exe";
+    //! Same values as --optimize
+    std::string optimizationLevel = "0";
+    //! Same values as --arch, or empty for the SDK's default
+    std::string arch;
+    //! Same values as --platform, or empty for the SDK's default
+    std::string platform;
+    //! Name and contents of each source file. The first one is the main file.
+    std::vector<std::pair<std::string, std::string>> sources;
+};
+
+struct CompileResponse
+{
+    bool success = false;
+    //! Everything the compiler logged while handling the request
+    std::string log;
+    //! Contents of the generated file
+    std::string output;
+};
+
+/*!
+ * Connects to the server listening on socketPath.
+ * @return Returns a socket descriptor, or -1 on failure.
+ */
+int connectToServer(const std::string& socketPath);
+
+/*!
+ * Creates a socket at socketPath and listens on it. An existing socket at
+ * that path is replaced, any other kind of file is not. The socket is only
+ * accessible to the user running the server (mode 0600). Must be called
+ * before any other threads are started, because it changes the umask.
+ * @return Returns a socket descriptor, or -1 on failure.
+ */
+int listenOnSocket(const std::string& socketPath);
+
+/*!
+ * Makes reads and writes on the socket fail once they block for longer than
+ * the given number of seconds, so a peer that stops sending or receiving
+ * can't hold on to the other side forever.
+ */
+bool setSocketTimeout(int fd, int seconds);
+
+void closeSocket(int fd);
+
+bool writeRequest(int fd, const CompileRequest& request);
+bool readRequest(int fd, CompileRequest* request);
+bool writeResponse(int fd, const CompileResponse& response);
+bool readResponse(int fd, CompileResponse* response);
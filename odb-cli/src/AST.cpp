@@ -5,6 +5,10 @@
 #include "odb-compiler/parsers/db/Driver.hpp"
 #include "odb-compiler/commands/CommandMatcher.hpp"
 #include "odb-sdk/Log.hpp"
+#include "odb-sdk/ScopedPhase.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
 
 using namespace odb;
 
@@ -14,6 +18,8 @@ static Reference<ast::Block> ast_;
 // ----------------------------------------------------------------------------
 bool initCommandMatcher(const std::vector<std::string>& args)
 {
+    ScopedPhase phase("initCommandMatcher");
+
     Log::ast(Log::INFO, "Updating command matcher\n");
     cmdMatcher_.updateFromIndex(getCommandIndex());
 
@@ -23,14 +29,46 @@ bool initCommandMatcher(const std::vector<std::string>& args)
 // ----------------------------------------------------------------------------
 bool parseDBA(const std::vector<std::string>& args)
 {
-    db::FileParserDriver driver;
-    for (const auto& arg : args)
-    {
-        Log::ast(Log::INFO, "Parsing file `%s`\n", arg.c_str());
-        Reference<ast::Block> block = driver.parse(arg, cmdMatcher_);
-        if (block == nullptr)
-            return false;
+    ScopedPhase phase("parseDBA");
+
+    // Files don't depend on each other and the command matcher is read-only,
+    // so each file is parsed by its own driver on a worker thread. Messages
+    // are buffered per file and printed in command-line order afterwards, so
+    // diagnostics of different files don't interleave.
+    std::vector<Reference<ast::Block>> blocks(args.size());
+    std::vector<ThreadLogBuffer> logs(args.size());
+    std::atomic<std::size_t> nextFile = 0;
+    std::atomic<bool> failed = false;
+    auto parseFiles = [&]() {
+        for (std::size_t i; !failed && (i = nextFile++) < args.size();)
+        {
+            logs[i].begin();
+            Log::ast(Log::INFO, "Parsing file `%s`\n", args[i].c_str());
+            db::FileParserDriver driver;
+            blocks[i] = driver.parse(args[i], cmdMatcher_);
+            if (blocks[i] == nullptr)
+                failed = true;
+            logs[i].end();
+        }
+    };
+
+    std::size_t threadCount = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), args.size());
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(parseFiles);
+    parseFiles();
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto& log : logs)
+        log.flush(Log::info);
 
+    if (failed)
+        return false;
+
+    // Merge in command-line order so the first file stays the main file
+    for (auto& block : blocks)
+    {
         if (ast_.isNull())
             ast_ = block;
         else
@@ -123,3 +161,9 @@ bool dumpASTJSON(const std::vector<std::string>& args)
 const odb::ast::Block* getAST() {
     return ast_;
 }
+
+// ----------------------------------------------------------------------------
+const odb::cmd::CommandMatcher& getCommandMatcher()
+{
+    return cmdMatcher_;
+}
@@ -11,112 +11,180 @@
 #include <fstream>
 #include <iostream>
 
-static odb::ir::OutputType outputType_ = odb::ir::OutputType::ObjectFile;
-static bool outputIsExecutable_ = true;
-static std::optional<odb::ir::TargetTriple::Arch> targetTripleArch_;
-static std::optional<odb::ir::TargetTriple::Platform> targetTriplePlatform_;
+static CodegenOptions options_;
 
 // ----------------------------------------------------------------------------
-bool setOutputType(const std::vector<std::string>& args)
+bool parseOutputType(const std::string& str, CodegenOptions* options)
 {
-    if (args[0] == "llvm-ir")
+    if (str == "llvm-ir")
     {
-        outputType_ = odb::ir::OutputType::LLVMIR;
+        options->outputType = odb::ir::OutputType::LLVMIR;
     }
-    else if (args[0] == "llvm-bc")
+    else if (str == "llvm-bc")
     {
-        outputType_ = odb::ir::OutputType::LLVMBitcode;
+        options->outputType = odb::ir::OutputType::LLVMBitcode;
     }
-    else if (args[0] == "obj" || args[0] == "exe")
+    else if (str == "obj" || str == "exe")
     {
-        outputType_ = odb::ir::OutputType::ObjectFile;
+        options->outputType = odb::ir::OutputType::ObjectFile;
+    }
+    else
+    {
+        odb::Log::codegen(odb::Log::ERROR, "Unknown output type `%s`\n", str.c_str());
+        return false;
     }
 
-    outputIsExecutable_ = args[0] == "exe";
+    options->outputIsExecutable = str == "exe";
 
     return true;
 }
 
 // ----------------------------------------------------------------------------
-bool setArch(const std::vector<std::string>& args)
+bool parseOptimizationLevel(const std::string& str, CodegenOptions* options)
 {
-    if (args[0] == "i386")
+    if (str == "0")
+    {
+        options->optimizationLevel = odb::ir::OptimizationLevel::O0;
+    }
+    else if (str == "1")
+    {
+        options->optimizationLevel = odb::ir::OptimizationLevel::O1;
+    }
+    else if (str == "2")
+    {
+        options->optimizationLevel = odb::ir::OptimizationLevel::O2;
+    }
+    else if (str == "3")
     {
-        targetTripleArch_ = odb::ir::TargetTriple::Arch::i386;
+        options->optimizationLevel = odb::ir::OptimizationLevel::O3;
     }
-    else if (args[0] == "x86_64")
+    else if (str == "s")
     {
-        targetTripleArch_ = odb::ir::TargetTriple::Arch::x86_64;
+        options->optimizationLevel = odb::ir::OptimizationLevel::Os;
     }
-    else if (args[0] == "aarch64")
+    else
     {
-        targetTripleArch_ = odb::ir::TargetTriple::Arch::AArch64;
+        odb::Log::codegen(odb::Log::ERROR, "Unknown optimization level `%s`\n", str.c_str());
+        return false;
     }
 
     return true;
 }
 
 // ----------------------------------------------------------------------------
-bool setPlatform(const std::vector<std::string>& args)
+bool parseArch(const std::string& str, CodegenOptions* options)
 {
-    if (args[0] == "windows")
+    if (str == "i386")
+    {
+        options->arch = odb::ir::TargetTriple::Arch::i386;
+    }
+    else if (str == "x86_64")
     {
-        targetTriplePlatform_ = odb::ir::TargetTriple::Platform::Windows;
+        options->arch = odb::ir::TargetTriple::Arch::x86_64;
     }
-    else if (args[0] == "macos")
+    else if (str == "aarch64")
     {
-        targetTriplePlatform_ = odb::ir::TargetTriple::Platform::macOS;
+        options->arch = odb::ir::TargetTriple::Arch::AArch64;
     }
-    else if (args[0] == "linux")
+    else
     {
-        targetTriplePlatform_ = odb::ir::TargetTriple::Platform::Linux;
+        odb::Log::codegen(odb::Log::ERROR, "Unknown architecture `%s`\n", str.c_str());
+        return false;
     }
 
     return true;
 }
 
 // ----------------------------------------------------------------------------
-bool output(const std::vector<std::string>& args)
+bool parsePlatform(const std::string& str, CodegenOptions* options)
 {
-    std::string outputName = args[0];
-    bool outputToStdout = outputName == "-";
+    if (str == "windows")
+    {
+        options->platform = odb::ir::TargetTriple::Platform::Windows;
+    }
+    else if (str == "macos")
+    {
+        options->platform = odb::ir::TargetTriple::Platform::macOS;
+    }
+    else if (str == "linux")
+    {
+        options->platform = odb::ir::TargetTriple::Platform::Linux;
+    }
+    else
+    {
+        odb::Log::codegen(odb::Log::ERROR, "Unknown platform `%s`\n", str.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool setOutputType(const std::vector<std::string>& args)
+{
+    return parseOutputType(args[0], &options_);
+}
+
+// ----------------------------------------------------------------------------
+bool setOptimizationLevel(const std::vector<std::string>& args)
+{
+    return parseOptimizationLevel(args[0], &options_);
+}
+
+// ----------------------------------------------------------------------------
+bool setArch(const std::vector<std::string>& args)
+{
+    return parseArch(args[0], &options_);
+}
+
+// ----------------------------------------------------------------------------
+bool setPlatform(const std::vector<std::string>& args)
+{
+    return parsePlatform(args[0], &options_);
+}
 
+// ----------------------------------------------------------------------------
+bool generateOutput(const odb::ast::Block* ast, const CodegenOptions& options, std::string& outputName,
+                    odb::ir::TargetMachineCache* targetMachines)
+{
+    bool outputToStdout = outputName == "-";
     auto* cmdIndex = getCommandIndex();
-    auto* ast = getAST();
 
     // Set default target triple if they are not specified by the user.
-    if (!targetTripleArch_)
+    std::optional<odb::ir::TargetTriple::Arch> targetTripleArch = options.arch;
+    std::optional<odb::ir::TargetTriple::Platform> targetTriplePlatform = options.platform;
+    if (!targetTripleArch)
     {
         if (getSDKType() == odb::SDKType::DarkBASIC)
         {
-            targetTripleArch_ = odb::ir::TargetTriple::Arch::i386;
+            targetTripleArch = odb::ir::TargetTriple::Arch::i386;
         }
         else
         {
-            targetTripleArch_ = odb::ir::TargetTriple::Arch::x86_64;
+            targetTripleArch = odb::ir::TargetTriple::Arch::x86_64;
         }
     }
-    if (!targetTriplePlatform_)
+    if (!targetTriplePlatform)
     {
         if (getSDKType() == odb::SDKType::DarkBASIC)
         {
-            targetTriplePlatform_ = odb::ir::TargetTriple::Platform::Windows;
+            targetTriplePlatform = odb::ir::TargetTriple::Platform::Windows;
         }
         else
         {
 #if defined(ODBCOMPILER_PLATFORM_LINUX)
-            targetTriplePlatform_ = odb::ir::TargetTriple::Platform::Linux;
+            targetTriplePlatform = odb::ir::TargetTriple::Platform::Linux;
 #elif defined(ODBCOMPILER_PLATFORM_MACOS)
-            targetTriplePlatform_ = odb::ir::TargetTriple::Platform::macOS;
+            targetTriplePlatform = odb::ir::TargetTriple::Platform::macOS;
 #elif defined(ODBCOMPILER_PLATFORM_WIN32)
-            targetTriplePlatform_ = odb::ir::TargetTriple::Platform::Windows;
+            targetTriplePlatform = odb::ir::TargetTriple::Platform::Windows;
 #else
 #error "Unknown host platform. Add a new default target platform for the current host."
 #endif
         }
     }
 
-    odb::ir::TargetTriple targetTriple{*targetTripleArch_, *targetTriplePlatform_};
+    odb::ir::TargetTriple targetTriple{*targetTripleArch, *targetTriplePlatform};
 
     // Run semantic checks and generate IR.
     auto program = odb::ir::runSemanticChecks(ast, *cmdIndex);
@@ -126,7 +194,7 @@ bool output(const std::vector<std::string>& args)
     }
 
     // Ensure that the executable extension is .exe if Windows is the target platform.
-    if (outputIsExecutable_ && targetTriplePlatform_ == odb::ir::TargetTriple::Platform::Windows)
+    if (options.outputIsExecutable && targetTriplePlatform == odb::ir::TargetTriple::Platform::Windows)
     {
         if (outputName.size() < 5 || outputName.substr(outputName.size() - 4, 4) != ".exe")
         {
@@ -148,15 +216,17 @@ bool output(const std::vector<std::string>& args)
         odb::Log::codegen(odb::Log::INFO, "Creating output file: `%s`\n", outputName.c_str());
     }
     std::ostream& outputStream = outputToStdout ? std::cout : *outputFile;
-    if (!odb::ir::generateCode(getSDKType(), outputType_, targetTriple, outputStream, "input.dba", *program, *cmdIndex))
+    if (!odb::ir::generateCode(getSDKType(), options.outputType, options.optimizationLevel, targetTriple, outputStream,
+                               "input.dba", *program, *cmdIndex, targetMachines))
     {
         return false;
     }
+    outputFile.reset();
 
     // If we're generating an executable, invoke the linker.
-    if (outputIsExecutable_)
+    if (options.outputIsExecutable)
     {
-        assert(outputType_ == odb::ir::OutputType::ObjectFile);
+        assert(options.outputType == odb::ir::OutputType::ObjectFile);
 
         // Select a linker. By default, we choose the locally embedded LLD linker.
         std::filesystem::path linker = odb::FileSystem::getPathToSelf().parent_path() / "lld/bin";
@@ -184,3 +254,33 @@ bool output(const std::vector<std::string>& args)
 
     return true;
 }
+
+// ----------------------------------------------------------------------------
+bool output(const std::vector<std::string>& args)
+{
+    std::string outputName = args[0];
+    return generateOutput(getAST(), options_, outputName, nullptr);
+}
+
+// ----------------------------------------------------------------------------
+bool run(const std::vector<std::string>& args)
+{
+    auto* cmdIndex = getCommandIndex();
+    auto* ast = getAST();
+
+    // Run semantic checks and generate IR.
+    auto program = odb::ir::runSemanticChecks(ast, *cmdIndex);
+    if (!program)
+    {
+        return false;
+    }
+
+    int exitCode;
+    if (!odb::ir::runProgram(getSDKType(), options_.optimizationLevel, "input.dba", *program, *cmdIndex, exitCode))
+    {
+        return false;
+    }
+
+    odb::Log::codegen(odb::Log::INFO, "Program exited with code %d\n", exitCode);
+    return exitCode == 0;
+}
@@ -1,18 +1,57 @@
 #include "odb-cli/Commands.hpp"
 #include "odb-cli/SDK.hpp"
+#include "odb-compiler/commands/CommandCache.hpp"
 #include "odb-compiler/commands/CommandIndex.hpp"
 #include "odb-compiler/commands/ODBCommandLoader.hpp"
 #include "odb-compiler/commands/DBPCommandLoader.hpp"
 #include "odb-sdk/Log.hpp"
+#include "odb-sdk/ScopedPhase.hpp"
 #include <algorithm>
+#include <cstdlib>
 
 using namespace odb;
 
 static cmd::CommandIndex cmdIndex_;
+static std::filesystem::path commandCacheFile_;
+static bool useCommandCache_ = true;
+
+// ----------------------------------------------------------------------------
+static std::filesystem::path defaultCommandCacheFile()
+{
+    std::filesystem::path cacheDir;
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg)
+        cacheDir = xdg;
+#if defined(ODBCOMPILER_PLATFORM_WIN32)
+    else if (const char* appData = std::getenv("LOCALAPPDATA"); appData && *appData)
+        cacheDir = appData;
+#endif
+    else if (const char* home = std::getenv("HOME"); home && *home)
+        cacheDir = std::filesystem::path(home) / ".cache";
+    else
+        cacheDir = getSDKRootDir();
+
+    return cacheDir / "odbc" / (getSDKType() == SDKType::ODB ? "odb-commands.cache" : "dbp-commands.cache");
+}
+
+// ----------------------------------------------------------------------------
+bool setCommandCacheFile(const std::vector<std::string>& args)
+{
+    commandCacheFile_ = args[0];
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool disableCommandCache(const std::vector<std::string>& args)
+{
+    useCommandCache_ = false;
+    return true;
+}
 
 // ----------------------------------------------------------------------------
 bool loadCommands(const std::vector<std::string>& args)
 {
+    ScopedPhase phase("loadCommands");
+
     std::unique_ptr<odb::cmd::CommandLoader> loader;
     switch (getSDKType())
     {
@@ -24,9 +63,21 @@ bool loadCommands(const std::vector<std::string>& args)
             break;
     }
 
+    std::unique_ptr<cmd::CommandCache> cache;
+    if (useCommandCache_)
+    {
+        cache = std::make_unique<cmd::CommandCache>(
+            commandCacheFile_.empty() ? defaultCommandCacheFile() : commandCacheFile_);
+        cache->load();
+        loader->setCommandCache(cache.get());
+    }
+
     if (!loader->populateIndex(&cmdIndex_))
         return false;
 
+    if (cache)
+        cache->save();
+
     if (cmdIndex_.findConflicts())
         return false;
 
@@ -0,0 +1,94 @@
+#include "odb-cli/Reports.hpp"
+#include "odb-sdk/Log.hpp"
+#include "odb-sdk/MemReport.hpp"
+#include "odb-sdk/TimeReport.hpp"
+
+using namespace odb;
+
+static bool printTimeReport_ = false;
+static std::string traceOutputFile_;
+static bool printMemReport_ = false;
+static std::string memReportJSONFile_;
+
+// ----------------------------------------------------------------------------
+bool enableTimeReport(const std::vector<std::string>& args)
+{
+    printTimeReport_ = true;
+    TimeReport::enable();
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool setTraceOutput(const std::vector<std::string>& args)
+{
+    traceOutputFile_ = args[0];
+    TimeReport::enable();
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool enableMemReport(const std::vector<std::string>& args)
+{
+    printMemReport_ = true;
+    MemReport::enable();
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool setMemReportJSONOutput(const std::vector<std::string>& args)
+{
+    memReportJSONFile_ = args[0];
+    MemReport::enable();
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+static FILE* openReportFile(const std::string& fileName)
+{
+    FILE* outFile = fopen(fileName.c_str(), "w");
+    if (!outFile)
+    {
+        Log::info.print(Log::FG_BRIGHT_RED, "Error: ");
+        Log::info.print("Failed to open file `%s`\n", fileName.c_str());
+    }
+
+    return outFile;
+}
+
+// ----------------------------------------------------------------------------
+bool writeReports()
+{
+    bool success = true;
+
+    if (printTimeReport_)
+        TimeReport::printSummary();
+
+    if (!traceOutputFile_.empty())
+    {
+        if (FILE* outFile = openReportFile(traceOutputFile_))
+        {
+            TimeReport::writeChromeTrace(outFile);
+            fclose(outFile);
+            Log::info.print("Wrote trace to `%s`\n", traceOutputFile_.c_str());
+        }
+        else
+            success = false;
+    }
+
+    if (printMemReport_)
+        MemReport::printSummary();
+
+    if (!memReportJSONFile_.empty())
+    {
+        if (FILE* outFile = openReportFile(memReportJSONFile_))
+        {
+            MemReport::writeJSON(outFile);
+            fclose(outFile);
+            Log::info.print("Wrote memory report to `%s`\n", memReportJSONFile_.c_str());
+        }
+        else
+            success = false;
+    }
+
+    return success;
+}
@@ -0,0 +1,409 @@
+#include "odb-cli/Server.hpp"
+#include "odb-cli/AST.hpp"
+#include "odb-cli/Codegen.hpp"
+#include "odb-cli/Commands.hpp"
+#include "odb-cli/ServerProtocol.hpp"
+#include "odb-compiler/ast/Block.hpp"
+#include "odb-compiler/commands/CommandIndex.hpp"
+#include "odb-compiler/parsers/db/Driver.hpp"
+#include "odb-sdk/Log.hpp"
+#include "odb-sdk/TimeReport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdarg>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+#if !defined(ODBCOMPILER_PLATFORM_WIN32)
+#   include <fcntl.h>
+#   include <poll.h>
+#   include <sys/socket.h>
+#   include <unistd.h>
+#endif
+
+using namespace odb;
+
+static int serverJobs_ = 0;
+
+// Clients send their whole request right after connecting and read the
+// response as soon as it is ready. One that stalls for longer than this is
+// dropped, so it can't keep a worker busy.
+static const int clientTimeoutSeconds = 30;
+
+// ----------------------------------------------------------------------------
+bool setServerJobs(const std::vector<std::string>& args)
+{
+    serverJobs_ = std::atoi(args[0].c_str());
+    if (serverJobs_ < 1)
+    {
+        Log::info.print(Log::FG_BRIGHT_RED, "[server] error: ");
+        Log::info.print("Invalid number of jobs `%s`\n", args[0].c_str());
+        return false;
+    }
+
+    return true;
+}
+
+#if defined(ODBCOMPILER_PLATFORM_WIN32)
+
+// ----------------------------------------------------------------------------
+bool runServer(const std::vector<std::string>& args)
+{
+    Log::info.print(Log::FG_BRIGHT_RED, "[server] error: ");
+    Log::info.print("--server is not supported on Windows yet\n");
+    return false;
+}
+
+#else
+
+namespace {
+
+class ClientQueue
+{
+public:
+    void push(int fd)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            clients_.push_back(fd);
+        }
+        cv_.notify_one();
+    }
+
+    // Returns -1 once the queue was closed and is empty
+    int pop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return closed_ || !clients_.empty(); });
+        if (clients_.empty())
+            return -1;
+
+        int fd = clients_.front();
+        clients_.pop_front();
+        return fd;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<int> clients_;
+    bool closed_ = false;
+};
+
+volatile std::sig_atomic_t stopRequested_ = 0;
+int stopPipe_[2] = {-1, -1};
+
+// A signal is delivered to any thread that doesn't block it, which is
+// usually one of the workers, so it can't be relied on to interrupt
+// accept(). Instead the handler wakes up the accepting thread through a
+// pipe it polls together with the socket.
+void requestStop(int)
+{
+    int savedErrno = errno;
+    stopRequested_ = 1;
+    char byte = 0;
+    if (::write(stopPipe_[1], &byte, 1) < 0)
+    {
+        // The pipe is full, so the accepting thread will wake up anyway
+    }
+    errno = savedErrno;
+}
+
+bool setFlag(int fd, int getCmd, int setCmd, int flag, bool enable)
+{
+    int flags = ::fcntl(fd, getCmd);
+    if (flags < 0)
+        return false;
+    return ::fcntl(fd, setCmd, enable ? flags | flag : flags & ~flag) == 0;
+}
+
+bool openStopPipe()
+{
+    if (::pipe(stopPipe_) != 0)
+        return false;
+
+    // The handler must never block on a full pipe
+    return setFlag(stopPipe_[0], F_GETFD, F_SETFD, FD_CLOEXEC, true)
+        && setFlag(stopPipe_[1], F_GETFD, F_SETFD, FD_CLOEXEC, true)
+        && setFlag(stopPipe_[1], F_GETFL, F_SETFL, O_NONBLOCK, true);
+}
+
+void closeStopPipe()
+{
+    for (int& fd : stopPipe_)
+    {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+}
+
+}
+
+// ----------------------------------------------------------------------------
+// Log::info isn't safe to print to from several threads, unless each of them
+// redirected it. While workers are running, everything the server itself
+// prints goes through here so messages don't interleave.
+static std::mutex logMutex_;
+
+static void printServerMessage(Log::Color color, const char* prefix, const char* fmt, ...)
+{
+    std::lock_guard<std::mutex> lock(logMutex_);
+    Log::info.print(color, "[server] %s", prefix);
+
+    va_list ap;
+    va_start(ap, fmt);
+    Log::info.vprint(fmt, ap);
+    va_end(ap);
+}
+
+// ----------------------------------------------------------------------------
+// Created with mode 0700 when the server starts and removed when it stops
+static std::filesystem::path outputDir_;
+
+static bool createOutputDir()
+{
+    std::string pattern = (std::filesystem::temp_directory_path() / "odbc-server-XXXXXX").string();
+    if (::mkdtemp(pattern.data()) == nullptr)
+        return false;
+
+    outputDir_ = pattern;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+static bool readFile(const std::filesystem::path& path, std::string* contents)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    contents->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+// ----------------------------------------------------------------------------
+static bool compile(const CompileRequest& request, ir::TargetMachineCache* targetMachines, std::string* output)
+{
+    CodegenOptions options;
+    if (!parseOutputType(request.outputType, &options)
+        || !parseOptimizationLevel(request.optimizationLevel, &options)
+        || (!request.arch.empty() && !parseArch(request.arch, &options))
+        || (!request.platform.empty() && !parsePlatform(request.platform, &options)))
+    {
+        return false;
+    }
+
+    if (request.sources.empty())
+    {
+        Log::ast(Log::ERROR, "Error: No source files were sent\n");
+        return false;
+    }
+
+    // Merge in the order they were sent so the first file stays the main file
+    Reference<ast::Block> ast;
+    for (const auto& [name, code] : request.sources)
+    {
+        db::StringParserDriver driver;
+        Reference<ast::Block> block = driver.parse(name, code, getCommandMatcher());
+        if (block == nullptr)
+            return false;
+
+        if (ast.isNull())
+            ast = block;
+        else
+            ast->merge(block);
+    }
+
+    // Code generation and the linker both write to a file, which is sent back
+    // to the client and then deleted. It lives in the server's private
+    // directory, so nobody else can put a symlink where it will be written.
+    // The name may get an extension appended by generateOutput().
+    static std::atomic<unsigned> nextOutputFile = 0;
+    std::string outputName = (outputDir_ / ("output-" + std::to_string(nextOutputFile++))).string();
+
+    bool success = generateOutput(ast, options, outputName, targetMachines)
+                && readFile(outputName, output);
+
+    std::error_code ec;
+    std::filesystem::remove(outputName, ec);
+
+    return success;
+}
+
+// ----------------------------------------------------------------------------
+static void handleClient(int fd, ir::TargetMachineCache* targetMachines)
+{
+    CompileRequest request;
+    if (!readRequest(fd, &request))
+    {
+        printServerMessage(Log::FG_BRIGHT_YELLOW, "warning: ", "Dropping client that sent an invalid request or timed out\n");
+        return;
+    }
+
+    // Everything logged while compiling is sent back to the client instead of
+    // ending up in the server's log
+    CompileResponse response;
+    FILE* log = std::tmpfile();
+    Log::redirectThread(log);
+    response.success = compile(request, targetMachines, &response.output);
+
+    // Each request's timings go back to its client. Taking them out of the
+    // report also keeps a long running server from collecting events forever.
+    if (TimeReport::enabled())
+        TimeReport::printSummary(TimeReport::takeThreadEvents());
+    Log::redirectThread(nullptr);
+
+    if (log)
+    {
+        std::fflush(log);
+        std::rewind(log);
+        char buffer[4096];
+        std::size_t bytesRead;
+        while ((bytesRead = std::fread(buffer, 1, sizeof(buffer), log)) > 0)
+            response.log.append(buffer, bytesRead);
+        std::fclose(log);
+    }
+
+    if (!writeResponse(fd, response))
+    {
+        printServerMessage(Log::FG_BRIGHT_YELLOW, "warning: ", "Client disconnected before receiving its response\n");
+    }
+}
+
+// ----------------------------------------------------------------------------
+bool runServer(const std::vector<std::string>& args)
+{
+    const std::string& socketPath = args[0];
+
+    int listenFd = listenOnSocket(socketPath);
+    if (listenFd < 0)
+    {
+        Log::info.print(Log::FG_BRIGHT_RED, "[server] error: ");
+        Log::info.print("Failed to listen on `%s`: %s\n", socketPath.c_str(), std::strerror(errno));
+        return false;
+    }
+
+    // The socket is only polled, so accept() must never block on a client
+    // that disconnected between poll() and accept()
+    if (!openStopPipe() || !setFlag(listenFd, F_GETFL, F_SETFL, O_NONBLOCK, true))
+    {
+        Log::info.print(Log::FG_BRIGHT_RED, "[server] error: ");
+        Log::info.print("Failed to set up the server socket: %s\n", std::strerror(errno));
+        closeStopPipe();
+        closeSocket(listenFd);
+        ::unlink(socketPath.c_str());
+        return false;
+    }
+
+    if (!createOutputDir())
+    {
+        Log::info.print(Log::FG_BRIGHT_RED, "[server] error: ");
+        Log::info.print("Failed to create a directory for output files: %s\n", std::strerror(errno));
+        closeStopPipe();
+        closeSocket(listenFd);
+        ::unlink(socketPath.c_str());
+        return false;
+    }
+
+    // Clients that disconnect early must not kill the server
+    struct sigaction action, oldIntAction, oldTermAction;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = requestStop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &oldIntAction);
+    sigaction(SIGTERM, &action, &oldTermAction);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    int jobs = serverJobs_ > 0 ? serverJobs_ : (int)std::max(1u, std::thread::hardware_concurrency());
+    Log::info.print(Log::FG_BRIGHT_GREEN, "[server] ");
+    Log::info.print("Listening on `%s` with %d worker%s\n", socketPath.c_str(), jobs, jobs == 1 ? "" : "s");
+
+    // Each worker keeps its own target machines, because they can't be used
+    // by several threads at once
+    ClientQueue queue;
+    std::vector<std::thread> workers;
+    for (int i = 0; i != jobs; ++i)
+        workers.emplace_back([&queue]() {
+            ir::TargetMachineCache targetMachines;
+            for (int fd; (fd = queue.pop()) >= 0;)
+            {
+                handleClient(fd, &targetMachines);
+                closeSocket(fd);
+            }
+        });
+
+    pollfd fds[2];
+    fds[0].fd = listenFd;
+    fds[0].events = POLLIN;
+    fds[1].fd = stopPipe_[0];
+    fds[1].events = POLLIN;
+    while (!stopRequested_)
+    {
+        if (::poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            printServerMessage(Log::FG_BRIGHT_RED, "error: ", "poll() failed: %s\n", std::strerror(errno));
+            break;
+        }
+        if (fds[1].revents != 0)
+            break;
+
+        int clientFd = ::accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN || errno == EWOULDBLOCK)
+                continue;
+            printServerMessage(Log::FG_BRIGHT_RED, "error: ", "accept() failed: %s\n", std::strerror(errno));
+            break;
+        }
+
+        // Some platforms pass O_NONBLOCK on to accepted sockets, but the
+        // workers rely on blocking reads with a timeout
+        setFlag(clientFd, F_GETFL, F_SETFL, O_NONBLOCK, false);
+        setSocketTimeout(clientFd, clientTimeoutSeconds);
+        queue.push(clientFd);
+    }
+
+    // Requests that were already accepted are still answered
+    queue.close();
+    for (auto& worker : workers)
+        worker.join();
+
+    // The handlers write to the pipe, so they have to go first
+    sigaction(SIGINT, &oldIntAction, nullptr);
+    sigaction(SIGTERM, &oldTermAction, nullptr);
+    closeStopPipe();
+
+    std::error_code ec;
+    std::filesystem::remove_all(outputDir_, ec);
+    closeSocket(listenFd);
+    ::unlink(socketPath.c_str());
+    Log::info.print(Log::FG_BRIGHT_GREEN, "[server] ");
+    Log::info.print("Stopped\n");
+
+    return stopRequested_ != 0;
+}
+
+#endif
@@ -0,0 +1,343 @@
+#include "odb-cli/ServerProtocol.hpp"
+#include "odb-sdk/config.hpp"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(ODBSDK_PLATFORM_WIN32)
+#   include <sys/socket.h>
+#   include <sys/stat.h>
+#   include <sys/time.h>
+#   include <sys/un.h>
+#   include <unistd.h>
+#endif
+
+static const char protocolMagic[4] = {'O', 'D', 'B', 'S'};
+static const std::uint32_t protocolVersion = 1;
+
+// Limits on what a peer can make the other side allocate. The server reads
+// requests from whoever connects, so these are kept close to what a real
+// program needs.
+static const std::uint32_t maxOptionLength = 256;
+static const std::uint32_t maxSourceNameLength = 4096;
+static const std::uint32_t maxSourceLength = 16 * 1024 * 1024;
+static const std::uint32_t maxSourceCount = 4096;
+static const std::uint32_t maxLogLength = 16 * 1024 * 1024;
+static const std::uint32_t maxOutputLength = 256 * 1024 * 1024;
+
+namespace {
+
+class MessageWriter
+{
+public:
+    MessageWriter()
+    {
+        buffer_.append(protocolMagic, sizeof(protocolMagic));
+        writeU32(protocolVersion);
+    }
+
+    void writeU32(std::uint32_t value)
+    {
+        char bytes[4] = {char(value), char(value >> 8), char(value >> 16), char(value >> 24)};
+        buffer_.append(bytes, 4);
+    }
+
+    void writeString(const std::string& str)
+    {
+        writeU32((std::uint32_t)str.size());
+        buffer_.append(str);
+    }
+
+    bool send(int fd) const;
+
+private:
+    std::string buffer_;
+};
+
+class MessageReader
+{
+public:
+    MessageReader(int fd) : fd_(fd) {}
+
+    bool readHeader()
+    {
+        char magic[sizeof(protocolMagic)];
+        std::uint32_t version;
+        return readBytes(magic, sizeof(magic))
+            && std::memcmp(magic, protocolMagic, sizeof(magic)) == 0
+            && readU32(&version)
+            && version == protocolVersion;
+    }
+
+    bool readU32(std::uint32_t* value)
+    {
+        unsigned char bytes[4];
+        if (!readBytes(bytes, 4))
+            return false;
+        *value = std::uint32_t(bytes[0])
+               | std::uint32_t(bytes[1]) << 8
+               | std::uint32_t(bytes[2]) << 16
+               | std::uint32_t(bytes[3]) << 24;
+        return true;
+    }
+
+    bool readString(std::string* str, std::uint32_t maxLength)
+    {
+        std::uint32_t length;
+        if (!readU32(&length) || length > maxLength)
+            return false;
+        str->resize(length);
+        return readBytes(str->data(), length);
+    }
+
+    bool readBytes(void* data, std::size_t size);
+
+private:
+    int fd_;
+};
+
+}
+
+#if defined(ODBSDK_PLATFORM_WIN32)
+
+// ----------------------------------------------------------------------------
+bool MessageWriter::send(int fd) const
+{
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+bool MessageReader::readBytes(void* data, std::size_t size)
+{
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+int connectToServer(const std::string& socketPath)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+// ----------------------------------------------------------------------------
+int listenOnSocket(const std::string& socketPath)
+{
+    errno = ENOSYS;
+    return -1;
+}
+
+// ----------------------------------------------------------------------------
+bool setSocketTimeout(int fd, int seconds)
+{
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+void closeSocket(int fd)
+{
+}
+
+#else
+
+// ----------------------------------------------------------------------------
+bool MessageWriter::send(int fd) const
+{
+    const char* data = buffer_.data();
+    std::size_t remaining = buffer_.size();
+    while (remaining > 0)
+    {
+        ssize_t written = ::write(fd, data, remaining);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        data += written;
+        remaining -= written;
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool MessageReader::readBytes(void* data, std::size_t size)
+{
+    char* dst = static_cast<char*>(data);
+    while (size > 0)
+    {
+        ssize_t bytesRead = ::read(fd_, dst, size);
+        if (bytesRead < 0 && errno == EINTR)
+            continue;
+        if (bytesRead <= 0)
+            return false;
+        dst += bytesRead;
+        size -= bytesRead;
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+static bool makeAddress(const std::string& socketPath, sockaddr_un* addr)
+{
+    std::memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(addr->sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+
+    std::memcpy(addr->sun_path, socketPath.c_str(), socketPath.size() + 1);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+int connectToServer(const std::string& socketPath)
+{
+    sockaddr_un addr;
+    if (!makeAddress(socketPath, &addr))
+        return -1;
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    if (::connect(fd, (const sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        return -1;
+    }
+
+    return fd;
+}
+
+// ----------------------------------------------------------------------------
+int listenOnSocket(const std::string& socketPath)
+{
+    sockaddr_un addr;
+    if (!makeAddress(socketPath, &addr))
+        return -1;
+
+    // A socket left behind by a server that didn't shut down cleanly would
+    // make bind() fail
+    struct stat st;
+    if (::lstat(socketPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        ::unlink(socketPath.c_str());
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    // Anyone who can connect can make the server read and write files, so
+    // only the user running it gets access. The socket file is created by
+    // bind() with permissions based on the umask, which avoids a window
+    // where the file exists with wider permissions. This changes the umask
+    // of the whole process, so it must happen before any threads start.
+    mode_t oldMask = ::umask(0177);
+    int bound = ::bind(fd, (const sockaddr*)&addr, sizeof(addr));
+    ::umask(oldMask);
+
+    if (bound != 0 || ::listen(fd, SOMAXCONN) != 0)
+    {
+        int error = errno;
+        ::close(fd);
+        errno = error;
+        return -1;
+    }
+
+    return fd;
+}
+
+// ----------------------------------------------------------------------------
+bool setSocketTimeout(int fd, int seconds)
+{
+    timeval timeout;
+    timeout.tv_sec = seconds;
+    timeout.tv_usec = 0;
+    return ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0
+        && ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) == 0;
+}
+
+// ----------------------------------------------------------------------------
+void closeSocket(int fd)
+{
+    ::close(fd);
+}
+
+#endif
+
+// ----------------------------------------------------------------------------
+bool writeRequest(int fd, const CompileRequest& request)
+{
+    MessageWriter writer;
+    writer.writeString(request.outputType);
+    writer.writeString(request.optimizationLevel);
+    writer.writeString(request.arch);
+    writer.writeString(request.platform);
+    writer.writeU32((std::uint32_t)request.sources.size());
+    for (const auto& [name, code] : request.sources)
+    {
+        writer.writeString(name);
+        writer.writeString(code);
+    }
+
+    return writer.send(fd);
+}
+
+// ----------------------------------------------------------------------------
+bool readRequest(int fd, CompileRequest* request)
+{
+    MessageReader reader(fd);
+    std::uint32_t sourceCount;
+    if (!reader.readHeader()
+        || !reader.readString(&request->outputType, maxOptionLength)
+        || !reader.readString(&request->optimizationLevel, maxOptionLength)
+        || !reader.readString(&request->arch, maxOptionLength)
+        || !reader.readString(&request->platform, maxOptionLength)
+        || !reader.readU32(&sourceCount)
+        || sourceCount > maxSourceCount)
+    {
+        return false;
+    }
+
+    request->sources.clear();
+    for (std::uint32_t i = 0; i != sourceCount; ++i)
+    {
+        std::string name, code;
+        if (!reader.readString(&name, maxSourceNameLength) || !reader.readString(&code, maxSourceLength))
+            return false;
+        request->sources.emplace_back(std::move(name), std::move(code));
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool writeResponse(int fd, const CompileResponse& response)
+{
+    MessageWriter writer;
+    writer.writeU32(response.success ? 1 : 0);
+    writer.writeString(response.log);
+    writer.writeString(response.output);
+
+    return writer.send(fd);
+}
+
+// ----------------------------------------------------------------------------
+bool readResponse(int fd, CompileResponse* response)
+{
+    MessageReader reader(fd);
+    std::uint32_t success;
+    if (!reader.readHeader()
+        || !reader.readU32(&success)
+        || !reader.readString(&response->log, maxLogLength)
+        || !reader.readString(&response->output, maxOutputLength))
+    {
+        return false;
+    }
+
+    response->success = success != 0;
+    return true;
+}
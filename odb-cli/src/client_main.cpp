@@ -0,0 +1,123 @@
+#include "odb-cli/ServerProtocol.hpp"
+#include "odb-sdk/config.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#if !defined(ODBSDK_PLATFORM_WIN32)
+#   include <sys/stat.h>
+#endif
+
+/*
+ * Thin client for odbc --server. It doesn't load the SDK or link against
+ * the compiler, it only sends source files to the server and writes back
+ * what it gets.
+ */
+
+// ----------------------------------------------------------------------------
+static void printUsage(const char* program)
+{
+    std::fprintf(stderr,
+        "Usage: %s <socket> [options] <file.dba> [files...]\n"
+        "Sends DBA source files to a running `odbc --server <socket>` and writes the\n"
+        "result. The first file is the main file.\n"
+        "  --output-type <exe|obj|llvm-ir|llvm-bc>  Default is exe\n"
+        "  -O <0|1|2|3|s>                           Optimization level, default is 0\n"
+        "  --arch <i386|x86_64|aarch64>             Default depends on the server's SDK\n"
+        "  --platform <windows|macos|linux>         Default depends on the server's SDK\n"
+        "  -o <file>                                Output file, default is stdout\n",
+        program);
+}
+
+// ----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const char* socketPath = argv[1];
+    const char* outputFile = nullptr;
+    CompileRequest request;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--output-type") == 0 && i + 1 < argc)
+            request.outputType = argv[++i];
+        else if (std::strcmp(argv[i], "-O") == 0 && i + 1 < argc)
+            request.optimizationLevel = argv[++i];
+        else if (std::strcmp(argv[i], "--arch") == 0 && i + 1 < argc)
+            request.arch = argv[++i];
+        else if (std::strcmp(argv[i], "--platform") == 0 && i + 1 < argc)
+            request.platform = argv[++i];
+        else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            outputFile = argv[++i];
+        else if (argv[i][0] == '-')
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+        else
+        {
+            std::ifstream file(argv[i], std::ios::binary);
+            if (!file.is_open())
+            {
+                std::fprintf(stderr, "Failed to open file `%s`\n", argv[i]);
+                return 1;
+            }
+            request.sources.emplace_back(argv[i],
+                std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()));
+        }
+    }
+
+    if (request.sources.empty())
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    int fd = connectToServer(socketPath);
+    if (fd < 0)
+    {
+        std::fprintf(stderr, "Failed to connect to `%s`: %s\n", socketPath, std::strerror(errno));
+        return 2;
+    }
+
+    CompileResponse response;
+    bool received = writeRequest(fd, request) && readResponse(fd, &response);
+    closeSocket(fd);
+    if (!received)
+    {
+        std::fprintf(stderr, "Lost connection to `%s`\n", socketPath);
+        return 2;
+    }
+
+    std::fwrite(response.log.data(), 1, response.log.size(), stderr);
+    if (!response.success)
+        return 1;
+
+    if (outputFile)
+    {
+        std::ofstream file(outputFile, std::ios::binary);
+        file.write(response.output.data(), response.output.size());
+        if (!file)
+        {
+            std::fprintf(stderr, "Failed to write `%s`\n", outputFile);
+            return 1;
+        }
+        file.close();
+
+#if !defined(ODBSDK_PLATFORM_WIN32)
+        if (request.outputType == "exe")
+            ::chmod(outputFile, 0755);
+#endif
+    }
+    else
+        std::cout.write(response.output.data(), response.output.size());
+
+    return 0;
+}
@@ -1,11 +1,13 @@
 #include "odb-cli/Actions.argdef.hpp"
+#include "odb-cli/Reports.hpp"
 #include "odb-sdk/Log.hpp"
 
 // ----------------------------------------------------------------------------
 int main(int argc, char** argv)
 {
-    if (!parseCommandLine(argc, argv))
-        return -1;
+    bool success = parseCommandLine(argc, argv);
+    if (!writeReports())
+        success = false;
 
-    return 0;
+    return success ? 0 : -1;
 }
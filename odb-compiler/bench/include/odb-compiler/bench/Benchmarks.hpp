@@ -0,0 +1,85 @@
+#pragma once
+
+#include "odb-compiler/commands/SDKType.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace benchmark {
+    class State;
+}
+
+namespace odb::cmd {
+    class CommandIndex;
+    class CommandMatcher;
+}
+
+/*!
+ * A DBA program from the dba-sources/ directory, loaded into memory so
+ * benchmarks don't measure file I/O.
+ */
+struct DBASource
+{
+    std::string name;
+    std::string code;
+    int lineCount;
+};
+
+/*!
+ * Returns every .dba file in dba-sources/, sorted by name. The files are
+ * loaded the first time this is called.
+ */
+const std::vector<DBASource>& dbaSources();
+
+/*!
+ * A program made by generateProgram(), for measuring how the compiler scales
+ * with the size of the program. Programs are generated the first time they
+ * are requested.
+ * @param[in] semantic If true, the program only uses constructs that get
+ * through semantic checks and calls commands from sdkCommands(). Otherwise
+ * it uses every construct and calls commands from keywordIniCommands().
+ */
+const DBASource& generatedSource(int lineCount, bool semantic);
+
+/*!
+ * Every command listed in the keyword .ini files in odb-sdk/keyword-ini-files.
+ * The commands don't have a plugin or a signature, which is all the matcher
+ * and the parser need. Entries that start with a built-in keyword are left
+ * out, because those are ignored by the parser with a warning.
+ */
+const odb::cmd::CommandIndex& keywordIniCommands();
+const odb::cmd::CommandMatcher& keywordIniMatcher();
+
+/*!
+ * Commands loaded from the plugins of an SDK, which are needed for semantic
+ * checks and code generation. The SDK is selected with the environment
+ * variables ODBC_BENCH_SDK_TYPE ("odb" or "dbp", default "odb") and
+ * ODBC_BENCH_SDK_ROOT (defaults to the ODB SDK in the build tree).
+ * @return Returns nullptr if no commands could be loaded.
+ */
+const odb::cmd::CommandIndex* sdkCommands();
+const odb::cmd::CommandMatcher& sdkMatcher();
+odb::SDKType sdkType();
+
+/*!
+ * Number of calls to operator new made by this process so far.
+ */
+std::uint64_t allocationCount();
+
+/*!
+ * Sets the "lines/s" and "allocs/line" counters of a benchmark that
+ * processed the given number of lines per iteration.
+ * @param[in] allocations Number of allocations made by all iterations.
+ */
+void setLineCounters(benchmark::State& state, int lineCount, std::uint64_t allocations);
+
+/*!
+ * Benchmarks are registered at runtime, because there is one benchmark per
+ * file in dba-sources/. The parser and IR benchmarks also register
+ * "scaling/..." benchmarks, which run on generated programs of 10k, 100k and
+ * 1M lines and report how the run time grows with the number of lines.
+ */
+void registerScannerBenchmarks();
+void registerCommandBenchmarks();
+void registerParserBenchmarks();
+void registerIRBenchmarks();
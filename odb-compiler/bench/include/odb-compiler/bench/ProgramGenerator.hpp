@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace odb::cmd {
+    class CommandIndex;
+}
+
+/*!
+ * Controls the shape of a program produced by generateProgram().
+ */
+struct ProgramOptions
+{
+    //! Exact number of lines the program will have
+    int lineCount = 10000;
+
+    //! The same seed, options and commands always produce the same program
+    std::uint32_t seed = 0;
+
+    /*!
+     * Commands are drawn from this index. Only commands whose arguments and
+     * return values are integers, floats or strings are used. If null, the
+     * program doesn't call any commands.
+     */
+    const odb::cmd::CommandIndex* commands = nullptr;
+
+    /*!
+     * Functions, subroutines, loops, conditionals, variable declarations and
+     * command calls are always generated. The following constructs are parsed
+     * but not yet supported by ir::runSemanticChecks(), so they have to be
+     * disabled for programs that are compiled further than the AST.
+     */
+    bool udts = true;
+    bool arrays = true;
+    bool select = true;
+};
+
+/*!
+ * Generates a valid DBA program of options.lineCount lines. Used to find
+ * super-linear behaviour in the compiler with programs much larger than the
+ * ones in dba-sources/.
+ */
+std::string generateProgram(const ProgramOptions& options);
+
+/*!
+ * Options for programs that have to get through semantic checks and code
+ * generation.
+ */
+ProgramOptions semanticProgramOptions(int lineCount, const odb::cmd::CommandIndex* commands);
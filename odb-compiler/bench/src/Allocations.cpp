@@ -0,0 +1,63 @@
+#include "benchmark/benchmark.h"
+#include "odb-compiler/bench/Benchmarks.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replacing the global allocation functions in the executable also counts
+// allocations made inside odb-compiler, as long as it is linked statically or
+// as a shared library on a platform with symbol interposition (Linux, macOS).
+static std::atomic<std::uint64_t> allocations{0};
+
+// ----------------------------------------------------------------------------
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+// ----------------------------------------------------------------------------
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+// ----------------------------------------------------------------------------
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+// ----------------------------------------------------------------------------
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+// ----------------------------------------------------------------------------
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+// ----------------------------------------------------------------------------
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+// ----------------------------------------------------------------------------
+std::uint64_t allocationCount()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+void setLineCounters(benchmark::State& state, int lineCount, std::uint64_t allocations)
+{
+    const double lines = (double)lineCount * (double)state.iterations();
+    state.counters["lines/s"] = benchmark::Counter(lines, benchmark::Counter::kIsRate);
+    state.counters["allocs/line"] = benchmark::Counter(lines > 0 ? (double)allocations / lines : 0.0);
+}
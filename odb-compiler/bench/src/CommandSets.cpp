@@ -0,0 +1,140 @@
+#include "odb-compiler/bench/Benchmarks.hpp"
+#include "odb-compiler/commands/Command.hpp"
+#include "odb-compiler/commands/CommandIndex.hpp"
+#include "odb-compiler/commands/CommandMatcher.hpp"
+#include "odb-compiler/commands/DBPCommandLoader.hpp"
+#include "odb-compiler/commands/ODBCommandLoader.hpp"
+#include "odb-compiler/parsers/db/KeywordToken.hpp"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <set>
+
+namespace fs = std::filesystem;
+using namespace odb;
+
+namespace {
+
+struct CommandSet
+{
+    cmd::CommandIndex index;
+    cmd::CommandMatcher matcher;
+    bool loaded = false;
+};
+
+// ----------------------------------------------------------------------------
+std::string trim(const std::string& str)
+{
+    auto begin = str.find_first_not_of(" \t\r");
+    auto end = str.find_last_not_of(" \t\r");
+    return begin == std::string::npos ? "" : str.substr(begin, end - begin + 1);
+}
+
+// ----------------------------------------------------------------------------
+CommandSet* loadKeywordIniCommands()
+{
+    auto set = new CommandSet;
+
+    // Each line of a keyword file is "COMMAND NAME=helpfile=arguments"
+    std::set<std::string> names;
+    for (const auto& entry : fs::directory_iterator(ODBCOMPILER_BENCH_KEYWORD_INI_DIR))
+    {
+        if (entry.path().extension() != ".ini")
+            continue;
+
+        std::ifstream file(entry.path());
+        std::string line;
+        while (std::getline(file, line))
+        {
+            auto eq = line.find('=');
+            if (line.empty() || line[0] == '[' || line[0] == ';' || eq == std::string::npos)
+                continue;
+
+            std::string name = trim(line.substr(0, eq));
+            if (name.empty())
+                continue;
+            if (db::KeywordToken::lookup(name.substr(0, name.find(' '))))
+                continue;
+            names.insert(name);
+        }
+    }
+
+    for (const auto& name : names)
+        set->index.addCommand(new cmd::Command(nullptr, name, "", cmd::Command::Type::Void, {}));
+    set->index.freeze();
+    set->matcher.updateFromIndex(&set->index);
+    set->loaded = true;
+
+    return set;
+}
+
+// ----------------------------------------------------------------------------
+CommandSet* loadSDKCommands()
+{
+    auto set = new CommandSet;
+
+    const char* root = std::getenv("ODBC_BENCH_SDK_ROOT");
+    fs::path sdkRoot = root ? root : ODBCOMPILER_BENCH_ODB_SDK_DIR;
+
+    std::unique_ptr<cmd::CommandLoader> loader;
+    if (sdkType() == SDKType::DarkBASIC)
+        loader = std::make_unique<cmd::DBPCommandLoader>(sdkRoot, std::vector<fs::path>());
+    else
+        loader = std::make_unique<cmd::ODBCommandLoader>(sdkRoot, std::vector<fs::path>());
+
+    if (loader->populateIndex(&set->index) && !set->index.commands().empty())
+    {
+        set->matcher.updateFromIndex(&set->index);
+        set->loaded = true;
+    }
+
+    return set;
+}
+
+}
+
+// ----------------------------------------------------------------------------
+static CommandSet& keywordIniCommandSet()
+{
+    static const std::unique_ptr<CommandSet> set(loadKeywordIniCommands());
+    return *set;
+}
+
+// ----------------------------------------------------------------------------
+const cmd::CommandIndex& keywordIniCommands()
+{
+    return keywordIniCommandSet().index;
+}
+
+// ----------------------------------------------------------------------------
+const cmd::CommandMatcher& keywordIniMatcher()
+{
+    return keywordIniCommandSet().matcher;
+}
+
+// ----------------------------------------------------------------------------
+SDKType sdkType()
+{
+    const char* type = std::getenv("ODBC_BENCH_SDK_TYPE");
+    return type && std::string(type) == "dbp" ? SDKType::DarkBASIC : SDKType::ODB;
+}
+
+// ----------------------------------------------------------------------------
+static CommandSet& sdkCommandSet()
+{
+    static const std::unique_ptr<CommandSet> set(loadSDKCommands());
+    return *set;
+}
+
+// ----------------------------------------------------------------------------
+const cmd::CommandIndex* sdkCommands()
+{
+    return sdkCommandSet().loaded ? &sdkCommandSet().index : nullptr;
+}
+
+// ----------------------------------------------------------------------------
+const cmd::CommandMatcher& sdkMatcher()
+{
+    return sdkCommandSet().matcher;
+}
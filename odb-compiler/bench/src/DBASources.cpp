@@ -0,0 +1,59 @@
+#include "odb-compiler/bench/Benchmarks.hpp"
+#include "odb-compiler/bench/ProgramGenerator.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+// ----------------------------------------------------------------------------
+const std::vector<DBASource>& dbaSources()
+{
+    static const std::vector<DBASource> sources = [] {
+        std::vector<DBASource> sources;
+        for (const auto& entry : fs::directory_iterator(ODBCOMPILER_BENCH_DBA_SOURCES_DIR))
+        {
+            if (entry.path().extension() != ".dba")
+                continue;
+
+            std::ifstream file(entry.path(), std::ios::binary);
+            std::stringstream ss;
+            ss << file.rdbuf();
+            std::string code = ss.str();
+            int lineCount = (int)std::count(code.begin(), code.end(), '\n') + 1;
+            sources.push_back({entry.path().filename().string(), std::move(code), lineCount});
+        }
+
+        std::sort(sources.begin(), sources.end(), [](const DBASource& a, const DBASource& b) {
+            return a.name < b.name;
+        });
+        return sources;
+    }();
+
+    return sources;
+}
+
+// ----------------------------------------------------------------------------
+const DBASource& generatedSource(int lineCount, bool semantic)
+{
+    static std::map<std::pair<int, bool>, DBASource> sources;
+
+    auto it = sources.find({lineCount, semantic});
+    if (it != sources.end())
+        return it->second;
+
+    ProgramOptions options;
+    if (semantic)
+        options = semanticProgramOptions(lineCount, sdkCommands());
+    else
+    {
+        options.lineCount = lineCount;
+        options.commands = &keywordIniCommands();
+    }
+
+    std::string name = "generated-" + std::to_string(lineCount) + (semantic ? "-semantic.dba" : ".dba");
+    return sources.emplace(std::make_pair(lineCount, semantic), DBASource{name, generateProgram(options), lineCount})
+        .first->second;
+}
@@ -0,0 +1,775 @@
+#include "odb-compiler/bench/ProgramGenerator.hpp"
+#include "odb-compiler/commands/Command.hpp"
+#include "odb-compiler/commands/CommandIndex.hpp"
+#include "odb-compiler/parsers/db/KeywordToken.hpp"
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <tuple>
+#include <vector>
+
+using namespace odb;
+
+namespace {
+
+// Every value in a generated program is one of these. That is enough to call
+// any command that only takes numbers and strings.
+enum class Kind
+{
+    Int,
+    Float,
+    String,
+    Void
+};
+
+struct GenCommand
+{
+    std::string name;
+    std::vector<Kind> args;
+    Kind returnKind;
+};
+
+struct GenFunction
+{
+    std::string name;
+    std::vector<Kind> args;
+};
+
+// Variables that can be referenced by the code that is currently being
+// generated. Subroutines share the scope of the main program.
+struct Scope
+{
+    std::vector<std::string> vars[3];
+    bool isMain = false;
+
+    const std::vector<std::string>& operator[](Kind kind) const { return vars[(int)kind]; }
+    std::vector<std::string>& operator[](Kind kind) { return vars[(int)kind]; }
+};
+
+// ----------------------------------------------------------------------------
+bool toKind(cmd::Command::Type type, Kind* kind)
+{
+    switch (type)
+    {
+        case cmd::Command::Type::Integer:
+        case cmd::Command::Type::Long:
+        case cmd::Command::Type::Dword: *kind = Kind::Int; return true;
+        case cmd::Command::Type::Float:
+        case cmd::Command::Type::Double: *kind = Kind::Float; return true;
+        case cmd::Command::Type::String: *kind = Kind::String; return true;
+        case cmd::Command::Type::Void: *kind = Kind::Void; return true;
+        default: return false;
+    }
+}
+
+// ----------------------------------------------------------------------------
+bool isUsableCommandName(const std::string& name)
+{
+    if (name.empty() || !std::isalpha((unsigned char)name[0]))
+        return false;
+
+    for (std::size_t i = 0; i != name.size(); ++i)
+    {
+        char c = name[i];
+        if (std::isalnum((unsigned char)c) || c == '_')
+            continue;
+        if (c == ' ' && name[i - 1] != ' ' && i + 1 != name.size())
+            continue;
+        if ((c == '$' || c == '#') && i + 1 == name.size())
+            continue;
+        return false;
+    }
+
+    // Words that are keywords would be scanned as keywords instead of being
+    // matched as part of the command
+    for (std::size_t begin = 0; begin < name.size();)
+    {
+        std::size_t end = std::min(name.find(' ', begin), name.size());
+        if (db::KeywordToken::lookup(std::string_view(name).substr(begin, end - begin)))
+            return false;
+        begin = end + 1;
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+class Generator
+{
+public:
+    explicit Generator(const ProgramOptions& options);
+
+    std::string generate();
+
+private:
+    int random(int n) { return (int)(rng_() % (std::uint32_t)n); }
+    bool chance(int percent) { return random(100) < percent; }
+    template <typename T>
+    const T& pick(const std::vector<T>& v) { return v[random((int)v.size())]; }
+
+    void line(const std::string& text);
+    int declarations(int maxLines);
+    int udtDeclaration(int index);
+    void function(int bodyLines);
+    void subroutine(int bodyLines);
+
+    void block(int lineCount, int depth);
+    void nested(int lineCount, int depth);
+    int bodySize(int available, int depth);
+    int compoundStatement(int maxLines, int depth);
+    void simpleStatement();
+    std::string singleLineStatement();
+
+    std::string literal(Kind kind);
+    std::string atom(Kind kind);
+    std::string expr(Kind kind, int depth);
+    std::string condition(int depth);
+    std::string callArgs(const std::vector<Kind>& args);
+    std::string declareLocal();
+
+    const ProgramOptions& options_;
+    std::mt19937 rng_;
+
+    std::vector<GenCommand> statementCommands_;
+    std::vector<GenCommand> expressionCommands_[3];
+    std::vector<GenFunction> functions_;
+    std::vector<std::string> zeroArgFunctions_;
+    std::vector<std::string> arrays_;
+    std::vector<std::vector<std::pair<std::string, Kind>>> udtFields_;
+    std::vector<std::string> udtFieldRefs_[3];
+    int subroutineCount_ = 0;
+
+    Scope mainScope_;
+    Scope* scope_ = nullptr;
+    std::string* out_ = nullptr;
+    int indent_ = 0;
+    int loopDepth_ = 0;
+    int localCount_ = 0;
+    std::string counterPrefix_;
+    bool inFunction_ = false;
+    bool inSubroutine_ = false;
+};
+
+// ----------------------------------------------------------------------------
+Generator::Generator(const ProgramOptions& options) :
+    options_(options),
+    rng_(options.seed)
+{
+    if (options.commands)
+    {
+        for (const auto& command : options.commands->commands())
+        {
+            std::string name = command->dbSymbol();
+            std::transform(name.begin(), name.end(), name.begin(), [](char c) { return (char)std::tolower(c); });
+            if (!isUsableCommandName(name))
+                continue;
+
+            GenCommand gen{name, {}, Kind::Void};
+            bool usable = toKind(command->returnType(), &gen.returnKind);
+            for (const auto& arg : command->args())
+            {
+                Kind kind;
+                usable = usable && toKind(arg.type, &kind) && kind != Kind::Void;
+                gen.args.push_back(kind);
+            }
+            if (!usable)
+                continue;
+
+            if (gen.returnKind == Kind::Void)
+                statementCommands_.push_back(std::move(gen));
+            else
+                expressionCommands_[(int)gen.returnKind].push_back(std::move(gen));
+        }
+
+        // The order commands are loaded in is not guaranteed, but the program
+        // has to be the same every time
+        auto byNameAndArgs = [](const GenCommand& a, const GenCommand& b) {
+            return std::tie(a.name, a.args) < std::tie(b.name, b.args);
+        };
+        std::sort(statementCommands_.begin(), statementCommands_.end(), byNameAndArgs);
+        for (auto& commands : expressionCommands_)
+            std::sort(commands.begin(), commands.end(), byNameAndArgs);
+    }
+
+    mainScope_.isMain = true;
+    for (int i = 0; i != 16; ++i)
+        mainScope_[Kind::Int].push_back("i_" + std::to_string(i));
+    for (int i = 0; i != 8; ++i)
+        mainScope_[Kind::Float].push_back("f_" + std::to_string(i) + "#");
+    for (int i = 0; i != 4; ++i)
+        mainScope_[Kind::String].push_back("s_" + std::to_string(i) + "$");
+}
+
+// ----------------------------------------------------------------------------
+std::string Generator::generate()
+{
+    // Subroutines are placed after the main program and jumped over, and
+    // functions have to come last
+    std::string main, subroutines, functions;
+    int remaining = options_.lineCount;
+
+    out_ = &main;
+    scope_ = &mainScope_;
+    counterPrefix_ = "c_";
+    remaining -= declarations(remaining);
+
+    while (remaining > 0)
+    {
+        int choice = random(100);
+        if (choice < 30 && remaining >= 3)
+        {
+            int lines = std::min(remaining, 3 + random(60));
+            out_ = &functions;
+            function(lines - 2);
+            remaining -= lines;
+        }
+        else if (choice < 45 && remaining >= (subroutineCount_ ? 3 : 5))
+        {
+            // The first subroutine pays for the goto and the label that skip
+            // over all of them
+            if (subroutineCount_ == 0)
+                remaining -= 2;
+            int lines = std::min(remaining, 3 + random(30));
+            out_ = &subroutines;
+            subroutine(lines - 2);
+            remaining -= lines;
+        }
+        else
+        {
+            int lines = std::min(remaining, 1 + random(48));
+            out_ = &main;
+            scope_ = &mainScope_;
+            block(lines, 0);
+            remaining -= lines;
+        }
+    }
+
+    if (subroutineCount_)
+    {
+        main += "goto gen_end\n";
+        main += subroutines;
+        main += "gen_end:\n";
+    }
+    main += functions;
+    return main;
+}
+
+// ----------------------------------------------------------------------------
+void Generator::line(const std::string& text)
+{
+    out_->append(indent_ * 4, ' ');
+    out_->append(text);
+    out_->push_back('\n');
+}
+
+// ----------------------------------------------------------------------------
+int Generator::declarations(int maxLines)
+{
+    // Keep small programs free of declarations, so they still consist of
+    // mostly code
+    if (maxLines < 200)
+        return 0;
+
+    int lines = 0;
+    if (options_.arrays)
+    {
+        int count = 1 + random(4);
+        for (int i = 0; i != count; ++i)
+        {
+            arrays_.push_back("arr_" + std::to_string(i));
+            line("dim " + arrays_.back() + "(100) as integer");
+        }
+        lines += count;
+    }
+
+    if (options_.udts)
+    {
+        int count = 1 + random(8);
+        for (int i = 0; i != count; ++i)
+            lines += udtDeclaration(i);
+
+        for (int i = 0; i != count; ++i)
+        {
+            std::string var = "u_" + std::to_string(i);
+            line(var + " as udt_" + std::to_string(i));
+            for (const auto& [path, kind] : udtFields_[i])
+                udtFieldRefs_[(int)kind].push_back(var + "." + path);
+        }
+        lines += count;
+    }
+
+    return lines;
+}
+
+// ----------------------------------------------------------------------------
+int Generator::udtDeclaration(int index)
+{
+    static const char* typeNames[] = {"integer", "float", "string"};
+    std::vector<std::pair<std::string, Kind>> fields;
+
+    line("type udt_" + std::to_string(index));
+    indent_++;
+    int fieldCount = 1 + random(4);
+    for (int i = 0; i != fieldCount; ++i)
+    {
+        Kind kind = (Kind)random(3);
+        std::string name = "m_" + std::to_string(i);
+        line(name + " as " + typeNames[(int)kind]);
+        fields.emplace_back(name, kind);
+    }
+
+    // Nest the previous UDT to get multi-level field accesses
+    if (index > 0)
+    {
+        std::string name = "m_" + std::to_string(fieldCount++);
+        line(name + " as udt_" + std::to_string(index - 1));
+        for (const auto& [path, kind] : udtFields_[index - 1])
+            fields.emplace_back(name + "." + path, kind);
+    }
+    indent_--;
+    line("endtype");
+
+    udtFields_.push_back(std::move(fields));
+    return fieldCount + 2;
+}
+
+// ----------------------------------------------------------------------------
+void Generator::function(int bodyLines)
+{
+    static const char* suffixes[] = {"", "#", "$"};
+
+    GenFunction gen{"fn_" + std::to_string(functions_.size()), {}};
+    Scope scope;
+    std::string params;
+    int argCount = random(4);
+    for (int i = 0; i != argCount; ++i)
+    {
+        Kind kind = (Kind)random(3);
+        std::string name = "p_" + std::to_string(i) + suffixes[(int)kind];
+        params += (i ? ", " : "") + name;
+        scope[kind].push_back(name);
+        gen.args.push_back(kind);
+    }
+    for (int i = 0; i != 4; ++i)
+        scope[Kind::Int].push_back("i_" + std::to_string(i));
+    scope[Kind::Float].push_back("f_0#");
+    scope[Kind::String].push_back("s_0$");
+
+    scope_ = &scope;
+    inFunction_ = true;
+    line("function " + gen.name + "(" + params + ")");
+    nested(bodyLines, 0);
+    line("endfunction " + pick(scope[Kind::Int]));
+    inFunction_ = false;
+
+    // Functions only call functions that were generated before them, so
+    // there is no recursion
+    if (gen.args.empty())
+        zeroArgFunctions_.push_back(gen.name);
+    functions_.push_back(std::move(gen));
+}
+
+// ----------------------------------------------------------------------------
+void Generator::subroutine(int bodyLines)
+{
+    // Subroutines only gosub subroutines that were generated before them
+    std::string label = "sub_" + std::to_string(subroutineCount_);
+    scope_ = &mainScope_;
+    counterPrefix_ = "cs" + std::to_string(subroutineCount_) + "_";
+    inSubroutine_ = true;
+    line(label + ":");
+    nested(bodyLines, 0);
+    line("return");
+    inSubroutine_ = false;
+    counterPrefix_ = "c_";
+    subroutineCount_++;
+}
+
+// ----------------------------------------------------------------------------
+void Generator::block(int lineCount, int depth)
+{
+    while (lineCount > 0)
+    {
+        if (lineCount >= 3 && depth < 6 && chance(20))
+            lineCount -= compoundStatement(lineCount, depth);
+        else
+        {
+            simpleStatement();
+            lineCount--;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+void Generator::nested(int lineCount, int depth)
+{
+    indent_++;
+    block(lineCount, depth + 1);
+    indent_--;
+}
+
+// ----------------------------------------------------------------------------
+int Generator::bodySize(int available, int depth)
+{
+    // Deeply nested blocks are kept short, like in hand written code
+    int limit = std::max(2, 24 >> depth);
+    return 1 + random(std::min(available, limit));
+}
+
+// ----------------------------------------------------------------------------
+int Generator::compoundStatement(int maxLines, int depth)
+{
+    // Every construct has at least 2 lines of its own and a body of at least
+    // one line, which the caller guarantees is available
+    switch (random(options_.select ? 8 : 7))
+    {
+        case 1: {
+            if (maxLines < 5)
+                break;
+            line("if " + condition(1));
+            int trueLines = bodySize(maxLines - 4, depth);
+            nested(trueLines, depth);
+            line("else");
+            int falseLines = bodySize(maxLines - 3 - trueLines, depth);
+            nested(falseLines, depth);
+            line("endif");
+            return trueLines + falseLines + 3;
+        }
+
+        case 2: {
+            if (maxLines < 7)
+                break;
+            line("if " + condition(1));
+            int lines1 = bodySize(maxLines - 6, depth);
+            nested(lines1, depth);
+            line("elseif " + condition(1));
+            int lines2 = bodySize(maxLines - 5 - lines1, depth);
+            nested(lines2, depth);
+            line("else");
+            int lines3 = bodySize(maxLines - 4 - lines1 - lines2, depth);
+            nested(lines3, depth);
+            line("endif");
+            return lines1 + lines2 + lines3 + 4;
+        }
+
+        case 3: {
+            std::string counter = counterPrefix_ + std::to_string(depth);
+            std::string end = expr(Kind::Int, 0);
+            std::string step = chance(25) ? " step " + std::to_string(1 + random(4)) : "";
+            line("for " + counter + " = 1 to " + end + step);
+            loopDepth_++;
+            int lines = bodySize(maxLines - 2, depth);
+            nested(lines, depth);
+            loopDepth_--;
+            line("next " + counter);
+            return lines + 2;
+        }
+
+        case 4: {
+            line("while " + condition(1));
+            loopDepth_++;
+            int lines = bodySize(maxLines - 2, depth);
+            nested(lines, depth);
+            loopDepth_--;
+            line("endwhile");
+            return lines + 2;
+        }
+
+        case 5: {
+            line("repeat");
+            loopDepth_++;
+            int lines = bodySize(maxLines - 2, depth);
+            nested(lines, depth);
+            loopDepth_--;
+            line("until " + condition(1));
+            return lines + 2;
+        }
+
+        case 6: {
+            if (maxLines < 4)
+                break;
+            line("do");
+            loopDepth_++;
+            int lines = bodySize(maxLines - 3, depth);
+            nested(lines, depth);
+            indent_++;
+            line("if " + condition(0) + " then exit");
+            indent_--;
+            loopDepth_--;
+            line("loop");
+            return lines + 3;
+        }
+
+        case 7: {
+            int caseCount = std::min(1 + random(4), (maxLines - 2) / 3);
+            if (caseCount < 1)
+                break;
+            line("select " + pick((*scope_)[Kind::Int]));
+            int remaining = maxLines - 2;
+            indent_++;
+            for (int i = 0; i != caseCount; ++i)
+            {
+                bool isDefault = i == caseCount - 1 && chance(40);
+                line(isDefault ? "case default" : "case " + std::to_string(i + 1));
+                int lines = bodySize(remaining - 2 - 3 * (caseCount - 1 - i), depth);
+                nested(lines, depth);
+                line("endcase");
+                remaining -= lines + 2;
+            }
+            indent_--;
+            line("endselect");
+            return maxLines - remaining;
+        }
+    }
+
+    line("if " + condition(1));
+    int lines = bodySize(maxLines - 2, depth);
+    nested(lines, depth);
+    line("endif");
+    return lines + 2;
+}
+
+// ----------------------------------------------------------------------------
+void Generator::simpleStatement()
+{
+    for (;;)
+    {
+        switch (random(14))
+        {
+            case 0:
+            case 1: {
+                std::string var = pick((*scope_)[Kind::Int]);
+                line(var + " = " + expr(Kind::Int, 2));
+                return;
+            }
+
+            case 2: {
+                std::string var = pick((*scope_)[Kind::Float]);
+                line(var + " = " + expr(Kind::Float, 2));
+                return;
+            }
+
+            case 3: {
+                std::string var = pick((*scope_)[Kind::String]);
+                line(var + " = " + expr(Kind::String, 0));
+                return;
+            }
+
+            case 4:
+                // Subroutines come after the main program, which could
+                // already have used the variable before its declaration
+                if (inSubroutine_)
+                    break;
+                line(declareLocal());
+                return;
+
+            case 5:
+            case 6:
+                if (statementCommands_.empty())
+                    break;
+                {
+                    const GenCommand& command = pick(statementCommands_);
+                    line(command.name + (command.args.empty() ? "" : " " + callArgs(command.args)));
+                }
+                return;
+
+            case 7:
+                if (functions_.empty())
+                    break;
+                {
+                    const GenFunction& function = pick(functions_);
+                    line(function.name + "(" + callArgs(function.args) + ")");
+                }
+                return;
+
+            case 8:
+                if (!scope_->isMain || subroutineCount_ == 0)
+                    break;
+                line("gosub sub_" + std::to_string(random(subroutineCount_)));
+                return;
+
+            case 9:
+                line("if " + condition(0) + " then " + singleLineStatement());
+                return;
+
+            case 10: {
+                std::string var = pick((*scope_)[Kind::Int]);
+                std::string op = chance(50) ? "inc " : "dec ";
+                line(op + var + (chance(50) ? "" : ", " + std::to_string(1 + random(9))));
+                return;
+            }
+
+            case 11:
+                if (!scope_->isMain || arrays_.empty())
+                    break;
+                {
+                    std::string array = pick(arrays_);
+                    std::string index = pick((*scope_)[Kind::Int]);
+                    line(array + "(" + index + ") = " + expr(Kind::Int, 1));
+                }
+                return;
+
+            case 12:
+            case 13: {
+                if (!scope_->isMain)
+                    break;
+                Kind kind = (Kind)random(3);
+                if (udtFieldRefs_[(int)kind].empty())
+                    break;
+                std::string field = pick(udtFieldRefs_[(int)kind]);
+                line(field + " = " + expr(kind, 1));
+                return;
+            }
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+std::string Generator::singleLineStatement()
+{
+    if (loopDepth_ > 0 && chance(30))
+        return "exit";
+    if (inFunction_ && chance(20))
+        return "exitfunction " + pick((*scope_)[Kind::Int]);
+
+    std::string var = pick((*scope_)[Kind::Int]);
+    return var + " = " + expr(Kind::Int, 1);
+}
+
+// ----------------------------------------------------------------------------
+std::string Generator::declareLocal()
+{
+    static const char* suffixes[] = {"", "#", "$"};
+    static const char* typeNames[] = {"integer", "float", "string"};
+
+    Kind kind = (Kind)random(3);
+    std::string name = "l_" + std::to_string(localCount_++) + suffixes[(int)kind];
+    std::string init = expr(kind, 1);
+    (*scope_)[kind].push_back(name);
+    return name + " as " + typeNames[(int)kind] + " = " + init;
+}
+
+// ----------------------------------------------------------------------------
+std::string Generator::literal(Kind kind)
+{
+    switch (kind)
+    {
+        case Kind::Int: return std::to_string(random(1000));
+        case Kind::Float: {
+            std::string integer = std::to_string(random(100));
+            return integer + "." + std::to_string(random(10));
+        }
+        default: return "\"str" + std::to_string(random(1000)) + "\"";
+    }
+}
+
+// ----------------------------------------------------------------------------
+std::string Generator::atom(Kind kind)
+{
+    // Atoms never start with '(', so any expression can be the first argument
+    // of a command statement
+    for (;;)
+    {
+        switch (random(7))
+        {
+            case 0:
+                return literal(kind);
+
+            case 1:
+            case 2:
+                return pick((*scope_)[kind]);
+
+            case 3: {
+                const auto& commands = expressionCommands_[(int)kind];
+                if (commands.empty())
+                    break;
+                const GenCommand& command = pick(commands);
+                return command.name + "(" + callArgs(command.args) + ")";
+            }
+
+            case 4:
+                if (kind != Kind::Int || zeroArgFunctions_.empty())
+                    break;
+                return pick(zeroArgFunctions_) + "()";
+
+            case 5: {
+                if (kind != Kind::Int || !scope_->isMain || arrays_.empty())
+                    break;
+                std::string array = pick(arrays_);
+                return array + "(" + std::to_string(random(100)) + ")";
+            }
+
+            case 6:
+                if (!scope_->isMain || udtFieldRefs_[(int)kind].empty())
+                    break;
+                return pick(udtFieldRefs_[(int)kind]);
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+std::string Generator::expr(Kind kind, int depth)
+{
+    static const char* ops[] = {" + ", " - ", " * "};
+
+    // Strings are only ever assigned, because string arithmetic isn't
+    // supported by code generation
+    if (kind == Kind::String || depth == 0 || chance(40))
+        return atom(kind);
+
+    std::string lhs = atom(kind);
+    const char* op = ops[random(3)];
+    if (chance(30))
+        return lhs + op + "(" + expr(kind, depth - 1) + ")";
+    return lhs + op + expr(kind, depth - 1);
+}
+
+// ----------------------------------------------------------------------------
+std::string Generator::condition(int depth)
+{
+    static const char* ops[] = {" = ", " <> ", " < ", " > ", " <= ", " >= "};
+
+    std::string lhs = atom(Kind::Int);
+    const char* op = ops[random(6)];
+    std::string cond = lhs + op + expr(Kind::Int, depth);
+    if (depth == 0 || !chance(15))
+        return cond;
+
+    const char* logicalOp = chance(50) ? " and " : " or ";
+    return "(" + cond + ")" + logicalOp + "(" + condition(0) + ")";
+}
+
+// ----------------------------------------------------------------------------
+std::string Generator::callArgs(const std::vector<Kind>& args)
+{
+    std::string result;
+    for (std::size_t i = 0; i != args.size(); ++i)
+    {
+        if (i)
+            result += ", ";
+        result += expr(args[i], 1);
+    }
+    return result;
+}
+
+}
+
+// ----------------------------------------------------------------------------
+std::string generateProgram(const ProgramOptions& options)
+{
+    if (options.lineCount <= 0)
+        return "";
+    return Generator(options).generate();
+}
+
+// ----------------------------------------------------------------------------
+ProgramOptions semanticProgramOptions(int lineCount, const cmd::CommandIndex* commands)
+{
+    ProgramOptions options;
+    options.lineCount = lineCount;
+    options.commands = commands;
+    options.udts = false;
+    options.arrays = false;
+    options.select = false;
+    return options;
+}
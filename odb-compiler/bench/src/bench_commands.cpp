@@ -0,0 +1,61 @@
+#include "benchmark/benchmark.h"
+#include "odb-compiler/bench/Benchmarks.hpp"
+#include "odb-compiler/commands/CommandIndex.hpp"
+#include "odb-compiler/commands/CommandMatcher.hpp"
+#include "odb-compiler/parsers/db/KeywordToken.hpp"
+#include "odb-sdk/Str.hpp"
+#include <cctype>
+
+using namespace odb;
+
+// ----------------------------------------------------------------------------
+static void findLongestCommandMatching(benchmark::State& state)
+{
+    // Every command followed by arguments, the way the parser sees them
+    std::vector<std::string> inputs;
+    for (const auto& name : keywordIniCommands().commandNamesAsList())
+        inputs.push_back(str::toLower(name) + " 1, 2");
+
+    const cmd::CommandMatcher& matcher = keywordIniMatcher();
+    for (auto _ : state)
+        for (const auto& input : inputs)
+            benchmark::DoNotOptimize(matcher.findLongestCommandMatching(input));
+
+    state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)inputs.size());
+    state.counters["commands"] = (double)inputs.size();
+}
+
+// ----------------------------------------------------------------------------
+static void keywordTokenLookup(benchmark::State& state)
+{
+    // Every word that appears in the sample programs, which is a realistic
+    // mix of keywords and symbols that aren't keywords
+    std::vector<std::string> words;
+    for (const auto& source : dbaSources())
+    {
+        std::string word;
+        for (char c : source.code)
+        {
+            if (std::isalnum((unsigned char)c) || c == '_')
+                word += c;
+            else if (!word.empty())
+            {
+                words.push_back(std::move(word));
+                word.clear();
+            }
+        }
+    }
+
+    for (auto _ : state)
+        for (const auto& word : words)
+            benchmark::DoNotOptimize(db::KeywordToken::lookup(word));
+
+    state.SetItemsProcessed((int64_t)state.iterations() * (int64_t)words.size());
+}
+
+// ----------------------------------------------------------------------------
+void registerCommandBenchmarks()
+{
+    benchmark::RegisterBenchmark("commands/findLongestCommandMatching", findLongestCommandMatching);
+    benchmark::RegisterBenchmark("commands/KeywordToken::lookup", keywordTokenLookup);
+}
@@ -0,0 +1,160 @@
+#include "benchmark/benchmark.h"
+#include "odb-compiler/ast/Block.hpp"
+#include "odb-compiler/bench/Benchmarks.hpp"
+#include "odb-compiler/ir/Codegen.hpp"
+#include "odb-compiler/ir/SemanticChecker.hpp"
+#include "odb-compiler/parsers/db/Driver.hpp"
+#include <ostream>
+#include <streambuf>
+
+using namespace odb;
+
+namespace {
+
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+// ----------------------------------------------------------------------------
+ir::TargetTriple targetTriple()
+{
+    // The DBP SDK only supports one target
+    if (sdkType() == SDKType::DarkBASIC)
+        return {ir::TargetTriple::Arch::i386, ir::TargetTriple::Platform::Windows};
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+    const ir::TargetTriple::Arch arch = ir::TargetTriple::Arch::AArch64;
+#elif defined(__x86_64__) || defined(_M_X64)
+    const ir::TargetTriple::Arch arch = ir::TargetTriple::Arch::x86_64;
+#else
+    const ir::TargetTriple::Arch arch = ir::TargetTriple::Arch::i386;
+#endif
+#if defined(ODBCOMPILER_PLATFORM_WIN32)
+    return {arch, ir::TargetTriple::Platform::Windows};
+#elif defined(ODBCOMPILER_PLATFORM_MACOS)
+    return {arch, ir::TargetTriple::Platform::macOS};
+#else
+    return {arch, ir::TargetTriple::Platform::Linux};
+#endif
+}
+
+// ----------------------------------------------------------------------------
+Reference<ast::Block> parseWithSDKCommands(benchmark::State& state, const DBASource& source)
+{
+    if (sdkCommands() == nullptr)
+    {
+        state.SkipWithError("No SDK commands, set ODBC_BENCH_SDK_TYPE and ODBC_BENCH_SDK_ROOT");
+        return nullptr;
+    }
+
+    db::StringParserDriver driver;
+    Reference<ast::Block> ast = driver.parse(source.name, source.code, sdkMatcher());
+    if (ast.isNull())
+        state.SkipWithError("Failed to parse");
+    return ast;
+}
+
+}
+
+// ----------------------------------------------------------------------------
+static void semanticChecks(benchmark::State& state, const DBASource& source)
+{
+    Reference<ast::Block> ast = parseWithSDKCommands(state, source);
+    if (ast.isNull())
+        return;
+
+    std::uint64_t allocations = 0;
+    for (auto _ : state)
+    {
+        std::uint64_t before = allocationCount();
+        ir::Ptr<ir::Program> program = ir::runSemanticChecks(ast, *sdkCommands());
+        allocations += allocationCount() - before;
+
+        if (program == nullptr)
+        {
+            state.SkipWithError("Semantic checks failed");
+            return;
+        }
+    }
+
+    setLineCounters(state, source.lineCount, allocations);
+}
+
+// ----------------------------------------------------------------------------
+static void codegen(benchmark::State& state, const DBASource& source)
+{
+    Reference<ast::Block> ast = parseWithSDKCommands(state, source);
+    if (ast.isNull())
+        return;
+
+    NullBuffer nullBuffer;
+    std::ostream output(&nullBuffer);
+
+    std::uint64_t allocations = 0;
+    for (auto _ : state)
+    {
+        // generateCode() takes the program by non-const reference, so every
+        // iteration gets a fresh one
+        state.PauseTiming();
+        ir::Ptr<ir::Program> program = ir::runSemanticChecks(ast, *sdkCommands());
+        state.ResumeTiming();
+
+        if (program == nullptr)
+        {
+            state.SkipWithError("Semantic checks failed");
+            return;
+        }
+
+        std::uint64_t before = allocationCount();
+        bool success = ir::generateCode(sdkType(), ir::OutputType::LLVMIR, ir::OptimizationLevel::O0,
+                                        targetTriple(), output, source.name, *program, *sdkCommands());
+        allocations += allocationCount() - before;
+
+        if (!success)
+        {
+            state.SkipWithError("Code generation failed");
+            return;
+        }
+    }
+
+    setLineCounters(state, source.lineCount, allocations);
+}
+
+// ----------------------------------------------------------------------------
+static void scalingSemanticChecks(benchmark::State& state)
+{
+    semanticChecks(state, generatedSource((int)state.range(0), true));
+    state.SetComplexityN(state.range(0));
+}
+
+// ----------------------------------------------------------------------------
+static void scalingCodegen(benchmark::State& state)
+{
+    codegen(state, generatedSource((int)state.range(0), true));
+    state.SetComplexityN(state.range(0));
+}
+
+// ----------------------------------------------------------------------------
+void registerIRBenchmarks()
+{
+    for (const auto& source : dbaSources())
+    {
+        benchmark::RegisterBenchmark(("semantic/" + source.name).c_str(), semanticChecks, source);
+        benchmark::RegisterBenchmark(("codegen/" + source.name).c_str(), codegen, source);
+    }
+
+    // The fitted complexity shows super-linear behaviour that is too small
+    // to notice on the programs in dba-sources/
+    for (auto [name, function] : {std::make_pair("scaling/semantic", scalingSemanticChecks),
+                                  std::make_pair("scaling/codegen", scalingCodegen)})
+    {
+        benchmark::RegisterBenchmark(name, function)
+            ->RangeMultiplier(10)
+            ->Range(10000, 1000000)
+            ->Unit(benchmark::kMillisecond)
+            ->Complexity();
+    }
+}
@@ -0,0 +1,52 @@
+#include "benchmark/benchmark.h"
+#include "odb-compiler/ast/Block.hpp"
+#include "odb-compiler/bench/Benchmarks.hpp"
+#include "odb-compiler/parsers/db/Driver.hpp"
+
+using namespace odb;
+
+// ----------------------------------------------------------------------------
+static void parser(benchmark::State& state, const DBASource& source)
+{
+    const cmd::CommandMatcher& matcher = keywordIniMatcher();
+    db::StringParserDriver driver;
+
+    std::uint64_t allocations = 0;
+    for (auto _ : state)
+    {
+        std::uint64_t before = allocationCount();
+        Reference<ast::Block> ast = driver.parse(source.name, source.code, matcher);
+        allocations += allocationCount() - before;
+
+        if (ast.isNull())
+        {
+            state.SkipWithError("Failed to parse");
+            return;
+        }
+
+        // Destroying the AST is part of the cost of parsing
+    }
+
+    state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)source.code.size());
+    setLineCounters(state, source.lineCount, allocations);
+}
+
+// ----------------------------------------------------------------------------
+static void scalingParser(benchmark::State& state)
+{
+    parser(state, generatedSource((int)state.range(0), false));
+    state.SetComplexityN(state.range(0));
+}
+
+// ----------------------------------------------------------------------------
+void registerParserBenchmarks()
+{
+    for (const auto& source : dbaSources())
+        benchmark::RegisterBenchmark(("parser/" + source.name).c_str(), parser, source);
+
+    benchmark::RegisterBenchmark("scaling/parser", scalingParser)
+        ->RangeMultiplier(10)
+        ->Range(10000, 1000000)
+        ->Unit(benchmark::kMillisecond)
+        ->Complexity();
+}
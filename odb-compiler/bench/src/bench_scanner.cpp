@@ -0,0 +1,37 @@
+#include "benchmark/benchmark.h"
+#include "odb-compiler/bench/Benchmarks.hpp"
+#include "odb-compiler/parsers/db/Driver.hpp"
+
+using namespace odb;
+
+// ----------------------------------------------------------------------------
+static void scanner(benchmark::State& state, const std::string& code)
+{
+    db::StringParserDriver driver;
+    int tokenCount = 0;
+    for (auto _ : state)
+    {
+        tokenCount = driver.scan(code);
+        benchmark::DoNotOptimize(tokenCount);
+    }
+
+    // Reported as MB/s
+    state.SetBytesProcessed((int64_t)state.iterations() * (int64_t)code.size());
+    state.counters["tokens/s"] = benchmark::Counter(
+        (double)tokenCount * (double)state.iterations(), benchmark::Counter::kIsRate);
+}
+
+// ----------------------------------------------------------------------------
+void registerScannerBenchmarks()
+{
+    // All files back to back, so the throughput isn't dominated by setting
+    // up the scanner for small files
+    std::string allSources;
+    for (const auto& source : dbaSources())
+    {
+        benchmark::RegisterBenchmark(("scanner/" + source.name).c_str(), scanner, source.code);
+        allSources += source.code;
+        allSources += "\n";
+    }
+    benchmark::RegisterBenchmark("scanner/all", scanner, allSources);
+}
@@ -0,0 +1,81 @@
+#include "odb-compiler/bench/Benchmarks.hpp"
+#include "odb-compiler/bench/ProgramGenerator.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// ----------------------------------------------------------------------------
+static void printUsage(const char* program)
+{
+    std::fprintf(stderr,
+        "Usage: %s <lines> [options]\n"
+        "Generates a DBA program with the specified number of lines.\n"
+        "  --seed <n>      Seed of the generator (default 0)\n"
+        "  --sdk           Draw commands from the SDK instead of the keyword .ini files.\n"
+        "                  The SDK is selected with ODBC_BENCH_SDK_TYPE and ODBC_BENCH_SDK_ROOT.\n"
+        "  --semantic      Only use constructs that get through semantic checks\n"
+        "  -o <file>       Write the program to a file instead of stdout\n",
+        program);
+}
+
+// ----------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    int lineCount = std::atoi(argv[1]);
+    std::uint32_t seed = 0;
+    bool useSDK = false;
+    bool semantic = false;
+    const char* outputFile = nullptr;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = (std::uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--sdk") == 0)
+            useSDK = true;
+        else if (std::strcmp(argv[i], "--semantic") == 0)
+            semantic = true;
+        else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            outputFile = argv[++i];
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    const odb::cmd::CommandIndex* commands = useSDK ? sdkCommands() : &keywordIniCommands();
+    if (commands == nullptr)
+    {
+        std::fprintf(stderr, "Failed to load SDK commands\n");
+        return 1;
+    }
+
+    ProgramOptions options = semantic ? semanticProgramOptions(lineCount, commands) : ProgramOptions();
+    options.lineCount = lineCount;
+    options.seed = seed;
+    options.commands = commands;
+    std::string program = generateProgram(options);
+
+    if (outputFile)
+    {
+        std::ofstream file(outputFile, std::ios::binary);
+        file.write(program.data(), program.size());
+        if (!file)
+        {
+            std::fprintf(stderr, "Failed to write `%s`\n", outputFile);
+            return 1;
+        }
+    }
+    else
+        std::cout.write(program.data(), program.size());
+
+    return 0;
+}
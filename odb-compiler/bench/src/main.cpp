@@ -0,0 +1,18 @@
+#include "benchmark/benchmark.h"
+#include "odb-compiler/bench/Benchmarks.hpp"
+
+int main(int argc, char** argv)
+{
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+
+    registerScannerBenchmarks();
+    registerCommandBenchmarks();
+    registerParserBenchmarks();
+    registerIRBenchmarks();
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
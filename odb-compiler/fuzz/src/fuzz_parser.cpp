@@ -0,0 +1,101 @@
+/*
+ * In-process fuzz target for the DBA parser. It works with libFuzzer
+ * (clang -fsanitize=fuzzer) and with AFL++ in persistent mode
+ * (afl-clang-fast++ -fsanitize=fuzzer), see README.md.
+ *
+ * Commands are loaded from the SDK and the command matcher is built once,
+ * so every input only pays for being scanned and parsed.
+ *
+ * Environment variables:
+ *   ODBC_FUZZ_SDK_TYPE  "odb" or "dbp", default "odb"
+ *   ODBC_FUZZ_SDK_ROOT  Defaults to the ODB SDK in the build tree
+ *   ODBC_FUZZ_SEMANTIC  If set to 1, inputs that parse are also passed to
+ *                       the semantic checks
+ *   ODBC_FUZZ_VERBOSE   If set to 1, parser errors are logged
+ */
+
+#include "odb-compiler/ast/Block.hpp"
+#include "odb-compiler/commands/CommandIndex.hpp"
+#include "odb-compiler/commands/CommandMatcher.hpp"
+#include "odb-compiler/commands/DBPCommandLoader.hpp"
+#include "odb-compiler/commands/ODBCommandLoader.hpp"
+#include "odb-compiler/ir/SemanticChecker.hpp"
+#include "odb-compiler/parsers/db/Driver.hpp"
+#include "odb-sdk/Log.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+namespace fs = std::filesystem;
+using namespace odb;
+
+static cmd::CommandIndex cmdIndex_;
+static cmd::CommandMatcher cmdMatcher_;
+static bool semanticChecks_ = false;
+
+// ----------------------------------------------------------------------------
+static bool envFlag(const char* name)
+{
+    const char* value = std::getenv(name);
+    return value && std::strcmp(value, "1") == 0;
+}
+
+// ----------------------------------------------------------------------------
+extern "C" int LLVMFuzzerInitialize(int* argc, char*** argv)
+{
+    const char* type = std::getenv("ODBC_FUZZ_SDK_TYPE");
+    const char* root = std::getenv("ODBC_FUZZ_SDK_ROOT");
+    fs::path sdkRoot = root ? root : ODBCOMPILER_FUZZ_ODB_SDK_DIR;
+
+    std::unique_ptr<cmd::CommandLoader> loader;
+    if (type && std::strcmp(type, "dbp") == 0)
+        loader = std::make_unique<cmd::DBPCommandLoader>(sdkRoot, std::vector<fs::path>());
+    else
+        loader = std::make_unique<cmd::ODBCommandLoader>(sdkRoot, std::vector<fs::path>());
+
+    // The parser works without commands, but the semantic checks need them
+    // to resolve command calls
+    semanticChecks_ = envFlag("ODBC_FUZZ_SEMANTIC");
+    if (!loader->populateIndex(&cmdIndex_) || cmdIndex_.commands().empty())
+    {
+        std::fprintf(stderr, "Failed to load commands from `%s`\n", sdkRoot.string().c_str());
+        if (semanticChecks_)
+            std::exit(1);
+    }
+    cmdMatcher_.updateFromIndex(&cmdIndex_);
+
+    // Almost every input is a syntax error. Formatting and printing the
+    // error would cost more than parsing.
+    if (!envFlag("ODBC_FUZZ_VERBOSE"))
+    {
+#if defined(ODBSDK_PLATFORM_WIN32)
+        FILE* null = std::fopen("NUL", "w");
+#else
+        FILE* null = std::fopen("/dev/null", "w");
+#endif
+        if (null)
+            Log::info = Log(null);
+    }
+
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    // A new driver for every input, so a crash can always be reproduced from
+    // the input alone
+    db::StringParserDriver driver;
+    Reference<ast::Block> ast = driver.parse("fuzz", std::string((const char*)data, size), cmdMatcher_);
+    if (ast.isNull())
+        return 0;
+
+    if (semanticChecks_)
+        ir::runSemanticChecks(ast, cmdIndex_);
+
+    return 0;
+}
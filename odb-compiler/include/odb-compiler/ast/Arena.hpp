@@ -0,0 +1,104 @@
+#pragma once
+
+#include "odb-compiler/config.hpp"
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace odb::ast {
+
+/*!
+ * @brief Bump allocator for the nodes and source locations of a single parse.
+ *
+ * While an ArenaScope is active on a thread, ast::Node and
+ * ast::SourceLocation objects created on that thread are carved out of
+ * large chunks instead of being allocated one by one. Objects are still
+ * reference counted and their destructors still run, but freeing one only
+ * decrements a counter. The chunks are released all at once when the scope
+ * has ended and the last object allocated from the arena is destroyed, so
+ * a tree can be kept alive (or partially kept alive) for as long as needed.
+ *
+ * Only the thread that owns the ArenaScope allocates from an arena, but
+ * objects allocated from it may be released by any thread, for example when
+ * a tree is handed to another thread. The live count is atomic for this
+ * reason.
+ */
+class ODBCOMPILER_PUBLIC_API Arena
+{
+public:
+    /*!
+     * @brief Allocates memory for an object. Uses the current thread's arena
+     * if there is one, otherwise the global heap.
+     */
+    static void* allocate(std::size_t size);
+
+    /*!
+     * @brief Frees memory returned by allocate(). If the memory came from an
+     * arena, this will free the whole arena if it was the last live
+     * allocation and the arena is no longer in use by an ArenaScope.
+     */
+    static void deallocate(void* p);
+
+    /*!
+     * @brief Returns the arena currently active on the calling thread, or
+     * null.
+     */
+    static Arena* current();
+
+    /*!
+     * @brief Returns the number of arenas that have not been freed yet,
+     * across all threads.
+     */
+    static std::size_t liveArenaCount();
+
+    /*!
+     * @brief Returns the number of objects allocated from this arena that
+     * have not been released yet.
+     */
+    std::size_t liveObjectCount() const;
+
+private:
+    friend class ArenaScope;
+
+    Arena();
+    ~Arena();
+
+    void* bump(std::size_t size);
+    void release();
+    void close();
+
+    struct Chunk
+    {
+        char* data;
+        std::size_t size;
+    };
+
+    std::vector<Chunk> chunks_;
+    char* head_;
+    char* end_;
+    // Live objects, plus one for the ArenaScope until it is closed. The arena
+    // deletes itself when this reaches zero.
+    std::atomic<std::size_t> liveCount_;
+    std::atomic<bool> closed_;
+};
+
+/*!
+ * @brief Creates a new arena and makes it the current arena of the calling
+ * thread until the scope is destroyed. The previous arena, if any, is
+ * restored afterwards.
+ */
+class ODBCOMPILER_PUBLIC_API ArenaScope
+{
+public:
+    ArenaScope();
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    Arena* arena_;
+    Arena* previous_;
+};
+
+}
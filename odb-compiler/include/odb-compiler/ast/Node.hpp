@@ -1,6 +1,8 @@
 #pragma once
 
 #include "odb-compiler/config.hpp"
+#include "odb-compiler/ast/Arena.hpp"
+#include "odb-sdk/MemReport.hpp"
 #include "odb-sdk/Reference.hpp"
 #include <string>
 
@@ -35,6 +37,18 @@ public:
     template <typename T>
     T* duplicate() const { return static_cast<T*>(duplicateImpl()); }
 
+    //! Allocated from the current ast::Arena, if any
+    static void* operator new(std::size_t size)
+    {
+        MemReport::track(MemCategory::ASTNode, size);
+        return Arena::allocate(size);
+    }
+    static void operator delete(void* p, std::size_t size)
+    {
+        MemReport::untrack(MemCategory::ASTNode, size);
+        Arena::deallocate(p);
+    }
+
 protected:
     virtual Node* duplicateImpl() const = 0;
 
@@ -1,15 +1,114 @@
 #pragma once
 
 #include "odb-compiler/config.hpp"
+#include "odb-compiler/ast/Arena.hpp"
 #include "odb-sdk/Log.hpp"
+#include "odb-sdk/MappedFile.hpp"
+#include "odb-sdk/MemReport.hpp"
 #include "odb-sdk/RefCounted.hpp"
-#include <istream>
+#include "odb-sdk/Reference.hpp"
+#include <string>
+#include <string_view>
 #include <vector>
-#include <memory>
 
 namespace odb {
 namespace ast {
 
+/*!
+ * @brief The source code a set of locations refer to. A single instance is
+ * shared between all locations created while parsing a file or string, so
+ * locations don't need to carry their own copy of the file name or code.
+ */
+class ODBCOMPILER_PUBLIC_API SourceBuffer : public RefCounted
+{
+public:
+    /*!
+     * @brief Returns the name of the file, or the name given to a string that
+     * was parsed
+     */
+    virtual const std::string& getName() const = 0;
+
+    /*!
+     * @brief Looks up a single line of the source code, without its line
+     * ending. The source code and an index of where each line starts are
+     * loaded the first time this is called, so subsequent lookups are O(1).
+     * @param[in] lineNumber Line number, starting at 1.
+     * @param[out] line Set to the contents of the line.
+     * @return Returns false if the line doesn't exist or if the source code
+     * is no longer available.
+     */
+    bool getLine(int lineNumber, std::string_view* line) const;
+
+    /*!
+     * @brief Converts a byte offset into the source code to a line and column
+     * number. Uses the same line index as getLine(), so each lookup is
+     * O(log n) in the number of lines.
+     * @param[in] offset Offset from the start of the source code.
+     * @param[out] line Set to the line number, starting at 1.
+     * @param[out] column Set to the column number, starting at 1. Every byte
+     * counts as one column.
+     * @return Returns false if the source code is not available.
+     */
+    bool getLineColumn(int offset, int* line, int* column) const;
+
+    /*!
+     * @brief Builds the line index from a copy of the source code that is
+     * already in memory, so getLineColumn() doesn't have to load the code
+     * again. Does nothing if the index was already built.
+     * @param[in] code Must be identical to the code returned by getCode().
+     */
+    void indexLines(std::string_view code) const;
+
+protected:
+    /*!
+     * @brief Retrieves the source code.
+     * @return Returns false if it is not available.
+     */
+    virtual bool getCode(std::string_view* code) const = 0;
+
+private:
+    bool buildLineIndex() const;
+
+    mutable std::vector<std::size_t> lineOffsets_;
+};
+
+class ODBCOMPILER_PUBLIC_API FileSourceBuffer : public SourceBuffer
+{
+public:
+    /*!
+     * @param[in] fileName The file the locations refer to.
+     * @param[in] file If the file was already mapped for parsing, pass the
+     * mapping here so diagnostics read from it instead of opening the file
+     * again. Otherwise the file is mapped the first time its code is needed.
+     */
+    explicit FileSourceBuffer(const std::string& fileName, MappedFile* file=nullptr);
+
+    const std::string& getName() const override;
+
+protected:
+    bool getCode(std::string_view* code) const override;
+
+private:
+    const std::string fileName_;
+    mutable Reference<MappedFile> file_;
+    mutable bool fileOpened_ = false;
+};
+
+class ODBCOMPILER_PUBLIC_API InlineSourceBuffer : public SourceBuffer
+{
+public:
+    InlineSourceBuffer(const std::string& sourceName, const std::string& code);
+
+    const std::string& getName() const override;
+
+protected:
+    bool getCode(std::string_view* code) const override;
+
+private:
+    const std::string sourceName_;
+    const std::string code_;
+};
+
 /*!
  * @brief Stores information on where a particular token or group of tokens
  * originated from (file, line and column).
@@ -19,11 +118,21 @@ namespace ast {
  * The first/last line range is inclusive, so lines 1-3 would mean lines 1, 2
  * and 3. The first/last column range is exclusive, so columns 1-3 would mean
  * columns 1 and 2. This is just an artefact of the way lexing is implemented.
+ *
+ * Locations created by the parser only store byte offsets. These are
+ * converted to lines and columns the first time any of them are accessed,
+ * because most locations are never looked at.
  */
 class ODBCOMPILER_PUBLIC_API SourceLocation : public RefCounted
 {
 public:
-    SourceLocation(int firstLine, int lastLine, int firstColumn, int lastColumn, Log::Color color=Log::RESET);
+    SourceLocation(SourceBuffer* source, int firstLine, int lastLine, int firstColumn, int lastColumn, Log::Color color=Log::RESET);
+
+    /*!
+     * @brief Creates a location from byte offsets into the source code. The
+     * last offset is exclusive.
+     */
+    SourceLocation(SourceBuffer* source, int firstOffset, int lastOffset, Log::Color color=Log::RESET);
 
     /*!
      * @brief Returns the location in the format "fl-ll:fc-lc" where fl=first line,
@@ -35,16 +144,20 @@ public:
      * @brief Returns the location in the format "file:line:column" (first line
      * and first column)
      */
-    virtual std::string getFileLineColumn() const = 0;
+    std::string getFileLineColumn() const;
 
     /*!
      * @brief Returns the affected lines from the source file or source text,
      * and inserts "squiggles" to highlight the parts that are relevant. The
      * strings can be "\n".join()'d to produce a printable block.
      */
-    virtual std::vector<std::string> getUnderlinedSection() const = 0;
+    std::vector<std::string> getUnderlinedSection() const;
 
-    virtual SourceLocation* duplicate() const = 0;
+    /*!
+     * @brief Creates a copy of this location. The source buffer is shared
+     * between both locations.
+     */
+    SourceLocation* duplicate() const;
 
     void printUnderlinedSection(Log& log) const;
 
@@ -53,49 +166,56 @@ public:
     int firstColumn() const;
     int lastColumn() const;
     Log::Color color() const;
+    SourceBuffer* source() const;
 
     void unionize(const SourceLocation* other);
 
-protected:
-    std::vector<std::string> getUnderlinedSection(std::istream& code) const;
+    //! Allocated from the current ast::Arena, if any
+    static void* operator new(std::size_t size)
+    {
+        MemReport::track(MemCategory::SourceLocation, size);
+        return Arena::allocate(size);
+    }
+    static void operator delete(void* p, std::size_t size)
+    {
+        MemReport::untrack(MemCategory::SourceLocation, size);
+        Arena::deallocate(p);
+    }
 
 protected:
-    int firstLine_;
-    int lastLine_;
-    int firstColumn_;
-    int lastColumn_;
+    void resolve() const;
+
+    Reference<SourceBuffer> source_;
+    mutable int firstLine_;
+    mutable int lastLine_;
+    mutable int firstColumn_;
+    mutable int lastColumn_;
+    int firstOffset_;
+    int lastOffset_;
+    mutable bool resolved_;
     Log::Color color_;
 };
 
+/*!
+ * @brief Convenience class for creating a location in a file with its own
+ * source buffer.
+ */
 class ODBCOMPILER_PUBLIC_API FileSourceLocation : public SourceLocation
 {
 public:
     FileSourceLocation(const std::string& fileName,
         int firstLine, int lastLine, int firstColumn, int lastColumn);
-
-    std::string getFileLineColumn() const override;
-    std::vector<std::string> getUnderlinedSection() const override;
-
-    SourceLocation* duplicate() const override;
-
-private:
-    std::string fileName_;
 };
 
+/*!
+ * @brief Convenience class for creating a location in a string with its own
+ * source buffer.
+ */
 class ODBCOMPILER_PUBLIC_API InlineSourceLocation : public SourceLocation
 {
 public:
     InlineSourceLocation(const std::string& sourceName, const std::string& code,
         int firstLine, int lastLine, int firstColumn, int lastColumn);
-
-    std::string getFileLineColumn() const override;
-    std::vector<std::string> getUnderlinedSection() const override;
-
-    SourceLocation* duplicate() const override;
-
-private:
-    std::string sourceName_;
-    std::string code_;
 };
 
 }
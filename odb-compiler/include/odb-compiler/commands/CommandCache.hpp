@@ -0,0 +1,82 @@
+#pragma once
+
+#include "odb-compiler/config.hpp"
+#include "odb-compiler/commands/Command.hpp"
+#include "odb-sdk/Reference.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace odb {
+namespace cmd {
+
+class CommandIndex;
+
+/*!
+ * Persistent on-disk cache of the commands extracted from each plugin, so
+ * plugins that haven't changed since the last run don't have to be parsed
+ * again.
+ *
+ * Entries are keyed by the plugin's path and validated against the plugin's
+ * size and modification time. If only the modification time changed, a hash
+ * of the plugin's contents decides whether the entry is still valid.
+ *
+ * The cache file is a flat, versioned binary file. It is rewritten by save()
+ * and only contains the plugins that were looked up or stored since load().
+ */
+class ODBCOMPILER_PUBLIC_API CommandCache
+{
+public:
+    explicit CommandCache(const std::filesystem::path& cacheFile);
+
+    /*!
+     * @brief Reads the cache file. If the file doesn't exist, is corrupt or
+     * was written by a different version, the cache starts out empty and
+     * false is returned.
+     */
+    bool load();
+
+    /*!
+     * @brief Writes the cache file, creating its parent directory if
+     * necessary.
+     */
+    bool save() const;
+
+    /*!
+     * @brief If the plugin is unchanged since it was stored, adds its commands
+     * to the index and returns true. The plugin itself is not parsed.
+     */
+    bool lookup(const std::filesystem::path& pluginPath, CommandIndex* index);
+
+    /*!
+     * @brief Stores the commands that were extracted from a plugin.
+     */
+    void store(const std::filesystem::path& pluginPath, const std::vector<Reference<Command>>& commands);
+
+private:
+    struct CachedCommand
+    {
+        std::string dbSymbol;
+        std::string cppSymbol;
+        std::string helpFile;
+        Command::Type returnType;
+        std::vector<Command::Arg> args;
+    };
+
+    struct Entry
+    {
+        std::uint64_t size = 0;
+        std::int64_t mtime = 0;
+        std::uint64_t hash = 0;
+        bool used = false;
+        std::vector<CachedCommand> commands;
+    };
+
+    const std::filesystem::path cacheFile_;
+    std::unordered_map<std::string, Entry> entries_;
+};
+
+}
+}
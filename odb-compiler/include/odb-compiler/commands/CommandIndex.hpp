@@ -4,9 +4,10 @@
 #include "odb-compiler/commands/SDKType.hpp"
 #include "odb-compiler/commands/Command.hpp"
 #include "odb-sdk/Reference.hpp"
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 
 namespace odb {
 namespace cmd {
@@ -18,31 +19,83 @@ namespace cmd {
  * This class is not designed for fast command queries. It is recommended to
  * create a specialized container if this is required. An example of this is
  * the @see CommandMatcher class.
+ *
+ * After freeze() the index, its commands and their plugins are read-only and
+ * can be shared by any number of concurrent compilations. References to
+ * commands and plugins are counted atomically for this reason.
  */
 class ODBCOMPILER_PUBLIC_API CommandIndex
 {
 public:
+    /*!
+     * @brief A view of all overloads of one command, in the order they were
+     * added to the index. Only valid until the next call to addCommand().
+     */
+    class OverloadSet
+    {
+    public:
+        OverloadSet() = default;
+        OverloadSet(const Command* const* begin, const Command* const* end) : begin_(begin), end_(end) {}
+
+        const Command* const* begin() const { return begin_; }
+        const Command* const* end() const { return end_; }
+        std::size_t size() const { return end_ - begin_; }
+        bool empty() const { return begin_ == end_; }
+        const Command* front() const { return *begin_; }
+        const Command* operator[](std::size_t i) const { return begin_[i]; }
+
+    private:
+        const Command* const* begin_ = nullptr;
+        const Command* const* end_ = nullptr;
+    };
+
     void addCommand(Command* command);
 
+    /*!
+     * @brief Builds the lookup tables used by lookup(). Has to be called
+     * after the last command was added and before the first lookup. The
+     * command loaders do this once they are done populating the index.
+     */
+    void freeze();
+
     /*!
      * @brief Tries to find any globally conflicting commands, such as identical
      * commands coming from different plugins, or commands that share the same
-     * overload.
+     * overload. The index must be frozen.
      */
     bool findConflicts() const;
 
     /*!
-     * @brief Performs a lookup by command name. Returns all matching overloads.
+     * @brief Performs a case-insensitive lookup by command name. Returns all
+     * matching overloads. The index must be frozen. Lookups never modify the
+     * index, so they are safe to do from any number of threads.
      */
-    std::vector<Reference<Command>> lookup(std::string commandName) const;
+    OverloadSet lookup(std::string_view commandName) const;
 
     const std::vector<Reference<Command>>& commands() const;
     std::vector<std::string> commandNamesAsList() const;
     std::vector<PluginInfo*> librariesAsList() const;
 
 private:
+    struct OverloadGroup
+    {
+        std::uint32_t nameOffset;
+        std::uint32_t nameLength;
+        std::uint32_t firstOverload;
+        std::uint32_t overloadCount;
+    };
+
     std::vector<Reference<Command>> commands_;
-    std::unordered_multimap<std::string, Reference<Command>> commandLookupTable_;
+
+    // Built by freeze(). Case-folded names are interned into one string, and
+    // all overloads of a command are stored next to each other. A perfect
+    // hash maps each name to its group of overloads.
+    bool frozen_ = true;
+    std::string namePool_;
+    std::vector<const Command*> overloads_;
+    std::vector<OverloadGroup> groups_;
+    std::vector<std::uint32_t> displacements_;
+    std::vector<std::uint32_t> slots_;
 };
 
 }
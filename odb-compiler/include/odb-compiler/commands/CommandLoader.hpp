@@ -10,6 +10,7 @@ namespace odb {
 class PluginInfo;
 
 namespace cmd {
+class CommandCache;
 class CommandIndex;
 
 class ODBCOMPILER_PUBLIC_API CommandLoader
@@ -23,9 +24,24 @@ public:
     virtual bool populateIndex(CommandIndex* index) = 0;
     virtual bool populateIndexFromLibrary(CommandIndex* index, PluginInfo* library) = 0;
 
+    /*!
+     * @brief Plugins found in the cache are not parsed again. Plugins that
+     * are parsed get stored in the cache. The cache must outlive the loader.
+     */
+    void setCommandCache(CommandCache* cache);
+
 protected:
+    /*!
+     * @brief Populates the index with the commands of each plugin, going
+     * through the command cache if one was set. Plugins are parsed on
+     * multiple threads, so populateIndexFromLibrary() may be called
+     * concurrently for different libraries.
+     */
+    bool populateIndexFromPlugins(CommandIndex* index, const std::vector<std::filesystem::path>& plugins);
+
     const std::filesystem::path sdkRoot_;
     const std::vector<std::filesystem::path> pluginDirs_;
+    CommandCache* cache_ = nullptr;
 };
 
 }
@@ -14,8 +14,14 @@ class CommandIndex;
  * The Purpose of this class is to provide the lexer a way to determine if
  * a sequence of symbol tokens represents a command or not.
  *
- * This class only stores the commands as strings and sorts them lexicographically
- * to make matching fast.
+ * The command names are compiled into a case-folded character trie, so
+ * matching a string costs O(length of the string) regardless of how many
+ * commands are loaded. The trie can also be walked incrementally through
+ * beginMatch() and continueMatch(), which lets the lexer feed it one token at
+ * a time.
+ *
+ * Once built with updateFromIndex(), the matcher is read-only. Any number of
+ * parsers can use one matcher concurrently.
  */
 class ODBCOMPILER_PUBLIC_API CommandMatcher
 {
@@ -27,7 +33,18 @@ public:
     };
 
     /*!
-     * Loads all commands as strings and sorts them lexicographically.
+     * State of an incremental match. Obtain one with beginMatch() and feed it
+     * characters with continueMatch().
+     */
+    struct MatchState
+    {
+        int node = -1;
+        int matchedLength = 0;
+        bool found = false;  // The characters matched so far spell out a command
+    };
+
+    /*!
+     * Loads all commands and builds the trie used for matching.
      */
     void updateFromIndex(const CommandIndex* index);
 
@@ -44,6 +61,22 @@ public:
      */
     MatchResult findLongestCommandMatching(const std::string& str) const;
 
+    /*!
+     * Returns a new state positioned before the first character of any command.
+     */
+    MatchState beginMatch() const;
+
+    /*!
+     * Advances the match by the given characters. Matching stops at the
+     * first character that cannot be part of a command, in which case
+     * MatchState::matchedLength is left at the number of characters that
+     * were accepted.
+     *
+     * @return Returns true if every character fed so far is a prefix of at
+     * least one command, false otherwise.
+     */
+    bool continueMatch(MatchState& state, const char* str, int len) const;
+
     /*!
      * Returns the longest possible match length. Useful for preallocating a
      * buffer.
@@ -57,7 +90,24 @@ public:
     int longestCommandWordCount() const;
 
 private:
-    std::vector<std::string> commands_;
+    int findChild(int node, char c) const;
+
+    struct Node
+    {
+        int firstEdge = 0;
+        int edgeCount = 0;
+        bool isCommand = false;
+    };
+
+    struct Edge
+    {
+        char c;
+        int node;
+    };
+
+    // Edges of each node are stored contiguously and sorted by character
+    std::vector<Node> nodes_;
+    std::vector<Edge> edges_;
     int longestCommandLength_ = 0;
     int longestCommandWordCount_ = 0;
 };
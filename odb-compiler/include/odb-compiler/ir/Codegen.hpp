@@ -1,14 +1,21 @@
 #pragma once
 
 #include <filesystem>
+#include <map>
 #include <memory>
 #include <ostream>
+#include <string>
+#include <utility>
 
 #include "odb-compiler/commands/CommandIndex.hpp"
 #include "odb-compiler/commands/SDKType.hpp"
 #include "odb-compiler/config.hpp"
 #include "odb-compiler/ir/Node.hpp"
 
+namespace llvm {
+class TargetMachine;
+}
+
 namespace odb::ir {
 enum class OutputType
 {
@@ -17,6 +24,15 @@ enum class OutputType
     ObjectFile
 };
 
+enum class OptimizationLevel
+{
+    O0,
+    O1,
+    O2,
+    O3,
+    Os
+};
+
 struct TargetTriple
 {
     enum class Arch
@@ -71,9 +87,33 @@ struct TargetTriple
     }
 };
 
-ODBCOMPILER_PUBLIC_API bool generateCode(SDKType sdkType, OutputType outputType, TargetTriple targetTriple,
-                                         std::ostream& output, const std::string& moduleName, Program& program,
-                                         const cmd::CommandIndex& cmdIndex);
+/*!
+ * Keeps LLVM target machines alive between calls to generateCode(), so a
+ * process that compiles many programs only creates one for each target and
+ * optimization level. A cache must only be used by one thread at a time.
+ */
+class ODBCOMPILER_PUBLIC_API TargetMachineCache
+{
+public:
+    TargetMachineCache();
+    ~TargetMachineCache();
+
+    TargetMachineCache(const TargetMachineCache&) = delete;
+    TargetMachineCache& operator=(const TargetMachineCache&) = delete;
+
+    llvm::TargetMachine* find(const std::string& llvmTargetTriple, OptimizationLevel optLevel) const;
+    llvm::TargetMachine* insert(const std::string& llvmTargetTriple, OptimizationLevel optLevel,
+                                std::unique_ptr<llvm::TargetMachine> targetMachine);
+
+private:
+    std::map<std::pair<std::string, OptimizationLevel>, std::unique_ptr<llvm::TargetMachine>> targetMachines_;
+};
+
+ODBCOMPILER_PUBLIC_API bool generateCode(SDKType sdkType, OutputType outputType, OptimizationLevel optLevel,
+                                         TargetTriple targetTriple, std::ostream& output, const std::string& moduleName, Program& program,
+                                         const cmd::CommandIndex& cmdIndex, TargetMachineCache* targetMachines = nullptr);
+ODBCOMPILER_PUBLIC_API bool runProgram(SDKType sdkType, OptimizationLevel optLevel, const std::string& moduleName,
+                                       Program& program, const cmd::CommandIndex& cmdIndex, int& exitCode);
 ODBCOMPILER_PUBLIC_API bool linkExecutable(SDKType sdkType, const std::filesystem::path& sdkRootDir,
                                            const std::filesystem::path& linker, TargetTriple targetTriple,
                                            std::vector<std::string> inputFilenames, std::string& outputFilename);
@@ -103,6 +103,10 @@ public:
 
     SourceLocation* location() const;
 
+    //! Counted for the memory report. Nodes stored by value aren't counted.
+    static void* operator new(std::size_t size);
+    static void operator delete(void* p, std::size_t size);
+
 private:
     Reference<SourceLocation> location_;
 };
@@ -123,6 +127,9 @@ public:
     Annotation annotation() const;
     const Type& type() const;
 
+    static void* operator new(std::size_t size);
+    static void operator delete(void* p, std::size_t size);
+
 private:
     std::string name_;
     Annotation annotation_;
@@ -2,24 +2,39 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "odb-sdk/Reference.hpp"
 
-namespace LIEF {
-class Binary;
-}
-
 namespace odb {
+struct PluginImage;
+
 class PluginInfo : public RefCounted {
 public:
     ~PluginInfo();
 
-    /// @brief Opens a dynamic lib (either dll, so, or dylib) for extracting data.
+    /// @brief Opens a dynamic lib (either a PE dll or an ELF so) for extracting data.
     static Reference<PluginInfo> open(const std::string& path);
 
+    /*!
+     * @brief Like open(), but the dynamic lib is only parsed once data other
+     * than its path or name is requested. Used when the commands of a plugin
+     * are already known, e.g. from the command cache.
+     */
+    static Reference<PluginInfo> openDeferred(const std::string& path);
+
+    /*!
+     * @brief Unmaps the dynamic lib and frees everything that was read from
+     * it. Views returned by lookupStringBySymbol() become invalid. The lib is
+     * mapped again if more data is requested. Must not be called while
+     * other threads use this plugin.
+     */
+    void releaseImage();
+
     /*!
      * @brief Returns the path of the dynamic lib.
      */
@@ -43,8 +58,9 @@ public:
 
     /*!
      * @brief Return the value of a null-terminated string pointed at by a symbol called 'name'.
+     * The returned view points into the mapped dynamic lib and is valid until releaseImage() is called.
      */
-     std::optional<std::string> lookupStringBySymbol(const std::string& name);
+    std::optional<std::string_view> lookupStringBySymbol(std::string_view name) const;
 
     /*!
      * @brief Returns a copy of all strings in the string table.
@@ -52,9 +68,12 @@ public:
     std::vector<std::string> getStringTable() const;
 
 private:
-    PluginInfo(std::unique_ptr<LIEF::Binary> binary, const std::string& path);
+    explicit PluginInfo(const std::string& path);
+
+    PluginImage* image() const;
 
-    std::unique_ptr<LIEF::Binary> binary_;
+    mutable std::mutex imageMutex_;
+    mutable std::unique_ptr<PluginImage> image_;
     const std::string path_;
     const std::string name_;
 };
@@ -3,6 +3,8 @@
 #include "odb-compiler/config.hpp"
 #include "odb-compiler/parsers/db/Scanner.hpp"
 #include "odb-sdk/Reference.hpp"
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -14,6 +16,7 @@ namespace ast {
     class Block;
     class Expression;
     class Literal;
+    class SourceBuffer;
     class SourceLocation;
     class UDTFieldOuter;
     class VarRef;
@@ -25,6 +28,24 @@ namespace cmd {
 
 namespace db {
 
+/*!
+ * Bump allocator for the strings of scanned tokens. Strings stay valid until
+ * reset() is called, which keeps the memory around for reuse, so scanning
+ * doesn't allocate once the arena has grown to fit the input.
+ */
+class TokenStringArena
+{
+public:
+    char* newString(const char* str, std::size_t len);
+    void reset();
+
+private:
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    std::vector<std::unique_ptr<char[]>> oversized_;
+    std::size_t chunk_ = 0;
+    std::size_t used_ = 0;
+};
+
 class ODBCOMPILER_PUBLIC_API Driver
 {
 public:
@@ -72,10 +93,17 @@ public:
 
     /*!
      * Factory method for converting a BISON location into a SourceLocation.
-     * Depending on whether a file is being parsed or a string is being parsed,
-     * this will return a different instance (handled by derived Driver classes)
+     * All locations created during a parse share the same source buffer,
+     * which is set up by the derived Driver classes.
      */
-    ODBCOMPILER_PRIVATE_API virtual ast::SourceLocation* newLocation(const DBLTYPE* loc) const = 0;
+    ODBCOMPILER_PRIVATE_API ast::SourceLocation* newLocation(const DBLTYPE* loc) const;
+
+    /*!
+     * Copies the text of a token into memory owned by the driver. FLEX uses
+     * this for the strings it passes to BISON through DBSTYPE::string. The
+     * string is valid until the end of the parse and must not be freed.
+     */
+    ODBCOMPILER_PRIVATE_API char* newTokenString(const char* str, std::size_t len);
 
     // ------------------------------------------------------------------------
     // Functions above used by BISON only
@@ -83,21 +111,19 @@ public:
 
 protected:
     ast::Block* doParse(dbscan_t scanner, dbpstate* parser, const cmd::CommandMatcher& commandMatcher);
+    int doScan(dbscan_t scanner);
+
+    odb::Reference<ast::SourceBuffer> source_;
 
 private:
     odb::Reference<ast::Block> program_;
+    TokenStringArena tokenStrings_;
 };
 
 class ODBCOMPILER_PUBLIC_API FileParserDriver : public Driver
 {
 public:
     ast::Block* parse(const std::string& fileName, const cmd::CommandMatcher& commandMatcher);
-
-protected:
-    virtual ast::SourceLocation* newLocation(const DBLTYPE* loc) const override;
-
-private:
-    const std::string* fileName_;
 };
 
 class ODBCOMPILER_PUBLIC_API StringParserDriver : public Driver
@@ -105,12 +131,12 @@ class ODBCOMPILER_PUBLIC_API StringParserDriver : public Driver
 public:
     ast::Block* parse(const std::string& sourceName, const std::string& str, const cmd::CommandMatcher& commandMatcher);
 
-protected:
-    virtual ast::SourceLocation* newLocation(const DBLTYPE* loc) const override;
-
-private:
-    const std::string* sourceName_;
-    const std::string* code_;
+    /*!
+     * Only runs the scanner over the string, without parsing or matching
+     * commands. Used to measure the scanner in isolation.
+     * @return Returns the number of tokens that were scanned.
+     */
+    int scan(const std::string& str);
 };
 
 }
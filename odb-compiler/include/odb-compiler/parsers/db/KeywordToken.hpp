@@ -1,17 +1,18 @@
 #pragma once
 
+#include "odb-compiler/config.hpp"
 #include "odb-compiler/parsers/db/Parser.y.hpp"
-#include <string>
+#include <string_view>
 
 namespace odb {
 namespace db {
 
-class KeywordToken
+class ODBCOMPILER_PUBLIC_API KeywordToken
 {
 public:
     struct Result { const char* name; dbtokentype token; };
 
-    static const Result* lookup(const std::string& keyword);
+    static const Result* lookup(std::string_view keyword);
 };
 
 }
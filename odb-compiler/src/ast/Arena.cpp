@@ -0,0 +1,170 @@
+#include "odb-compiler/ast/Arena.hpp"
+#include "odb-sdk/MemReport.hpp"
+#include <cassert>
+#include <new>
+
+namespace odb {
+namespace ast {
+
+namespace {
+
+// Every allocation is preceded by a header recording which arena it came
+// from, so deallocate() can tell arena memory from heap memory. The header
+// is padded so objects keep the strictest fundamental alignment.
+struct alignas(alignof(std::max_align_t)) Header
+{
+    Arena* arena;
+};
+
+const std::size_t chunkSize = 64 * 1024;
+
+// Allocations larger than this get a chunk of their own, so a large node
+// doesn't waste the remainder of the current chunk
+const std::size_t largeAllocationSize = chunkSize / 4;
+
+std::size_t alignSize(std::size_t size)
+{
+    const std::size_t align = alignof(std::max_align_t);
+    return (size + align - 1) & ~(align - 1);
+}
+
+Arena*& currentArena()
+{
+    static thread_local Arena* arena = nullptr;
+    return arena;
+}
+
+std::atomic<std::size_t> liveArenas(0);
+
+}
+
+// ----------------------------------------------------------------------------
+Arena::Arena() :
+    head_(nullptr),
+    end_(nullptr),
+    liveCount_(1),
+    closed_(false)
+{
+    liveArenas.fetch_add(1, std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+Arena::~Arena()
+{
+    assert(liveCount_ == 0);
+    liveArenas.fetch_sub(1, std::memory_order_relaxed);
+    for (const Chunk& chunk : chunks_)
+    {
+        MemReport::untrack(MemCategory::ASTArena, chunk.size);
+        ::operator delete(chunk.data);
+    }
+}
+
+// ----------------------------------------------------------------------------
+void* Arena::allocate(std::size_t size)
+{
+    std::size_t totalSize = sizeof(Header) + alignSize(size);
+    Arena* arena = currentArena();
+
+    Header* header = static_cast<Header*>(
+        arena ? arena->bump(totalSize) : ::operator new(totalSize));
+    header->arena = arena;
+    return header + 1;
+}
+
+// ----------------------------------------------------------------------------
+void Arena::deallocate(void* p)
+{
+    if (p == nullptr)
+        return;
+
+    Header* header = static_cast<Header*>(p) - 1;
+    if (header->arena)
+        header->arena->release();
+    else
+        ::operator delete(header);
+}
+
+// ----------------------------------------------------------------------------
+Arena* Arena::current()
+{
+    return currentArena();
+}
+
+// ----------------------------------------------------------------------------
+std::size_t Arena::liveArenaCount()
+{
+    return liveArenas.load(std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+std::size_t Arena::liveObjectCount() const
+{
+    std::size_t count = liveCount_.load(std::memory_order_acquire);
+    return closed_.load(std::memory_order_acquire) ? count : count - 1;
+}
+
+// ----------------------------------------------------------------------------
+void* Arena::bump(std::size_t size)
+{
+    assert(closed_ == false);
+
+    if (size > largeAllocationSize)
+    {
+        char* data = static_cast<char*>(::operator new(size));
+        chunks_.push_back({data, size});
+        MemReport::track(MemCategory::ASTArena, size);
+        liveCount_.fetch_add(1, std::memory_order_relaxed);
+        return data;
+    }
+
+    if (static_cast<std::size_t>(end_ - head_) < size)
+    {
+        char* data = static_cast<char*>(::operator new(chunkSize));
+        chunks_.push_back({data, chunkSize});
+        MemReport::track(MemCategory::ASTArena, chunkSize);
+        head_ = data;
+        end_ = data + chunkSize;
+    }
+
+    void* p = head_;
+    head_ += size;
+    liveCount_.fetch_add(1, std::memory_order_relaxed);
+    return p;
+}
+
+// ----------------------------------------------------------------------------
+void Arena::release()
+{
+    assert(liveCount_ > 0);
+    if (liveCount_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete this;
+}
+
+// ----------------------------------------------------------------------------
+void Arena::close()
+{
+    // The scope's share of the live count keeps the arena alive while it is
+    // still being allocated from. Dropping it through release() means only
+    // one thread can ever see the count reach zero.
+    closed_.store(true, std::memory_order_release);
+    release();
+}
+
+// ----------------------------------------------------------------------------
+ArenaScope::ArenaScope() :
+    arena_(new Arena),
+    previous_(currentArena())
+{
+    currentArena() = arena_;
+}
+
+// ----------------------------------------------------------------------------
+ArenaScope::~ArenaScope()
+{
+    currentArena() = previous_;
+    arena_->close();
+}
+
+}
+}
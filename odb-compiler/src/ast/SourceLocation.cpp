@@ -1,44 +1,195 @@
 #include "odb-compiler/ast/SourceLocation.hpp"
 #include "odb-sdk/Str.hpp"
-#include <fstream>
+#include <algorithm>
+#include <cstring>
 #include <vector>
-#include <sstream>
 #include <cassert>
 
 namespace odb {
 namespace ast {
 
 // ----------------------------------------------------------------------------
-SourceLocation::SourceLocation(int firstLine, int lastLine, int firstColumn, int lastColumn, Log::Color color) :
+bool SourceBuffer::buildLineIndex() const
+{
+    // The index only has to be built once. The code isn't needed after that
+    if (!lineOffsets_.empty())
+        return true;
+
+    std::string_view code;
+    if (!getCode(&code))
+        return false;
+
+    indexLines(code);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+void SourceBuffer::indexLines(std::string_view code) const
+{
+    if (!lineOffsets_.empty())
+        return;
+
+    // Every '\n' starts a new line, so there is always at least one (possibly
+    // empty) line
+    lineOffsets_.push_back(0);
+    const char* begin = code.data();
+    const char* end = begin + code.size();
+    for (const char* p = begin; (p = static_cast<const char*>(std::memchr(p, '\n', end - p))) != nullptr; ++p)
+        lineOffsets_.push_back(p - begin + 1);
+}
+
+// ----------------------------------------------------------------------------
+bool SourceBuffer::getLine(int lineNumber, std::string_view* line) const
+{
+    std::string_view code;
+    if (!buildLineIndex() || !getCode(&code))
+        return false;
+
+    if (lineNumber < 1 || lineNumber > (int)lineOffsets_.size())
+        return false;
+
+    std::size_t begin = lineOffsets_[lineNumber - 1];
+    std::size_t end = lineNumber < (int)lineOffsets_.size() ?
+        lineOffsets_[lineNumber] - 1 : code.size();
+    *line = code.substr(begin, end - begin);
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool SourceBuffer::getLineColumn(int offset, int* line, int* column) const
+{
+    if (!buildLineIndex())
+        return false;
+
+    // Find the last line starting at or before the offset
+    auto it = std::upper_bound(lineOffsets_.begin(), lineOffsets_.end(), (std::size_t)offset);
+    *line = (int)(it - lineOffsets_.begin());
+    *column = offset - (int)*(it - 1) + 1;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+FileSourceBuffer::FileSourceBuffer(const std::string& fileName, MappedFile* file) :
+    fileName_(fileName),
+    file_(file),
+    fileOpened_(file != nullptr)
+{
+}
+
+// ----------------------------------------------------------------------------
+const std::string& FileSourceBuffer::getName() const
+{
+    return fileName_;
+}
+
+// ----------------------------------------------------------------------------
+bool FileSourceBuffer::getCode(std::string_view* code) const
+{
+    // Only map the file once, no matter how many diagnostics are printed
+    if (!fileOpened_)
+    {
+        fileOpened_ = true;
+        file_ = MappedFile::open(fileName_.c_str());
+    }
+
+    if (file_.isNull())
+        return false;
+
+    *code = std::string_view(file_->data(), file_->size());
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+InlineSourceBuffer::InlineSourceBuffer(const std::string& sourceName, const std::string& code) :
+    sourceName_(sourceName),
+    code_(code)
+{
+}
+
+// ----------------------------------------------------------------------------
+const std::string& InlineSourceBuffer::getName() const
+{
+    return sourceName_;
+}
+
+// ----------------------------------------------------------------------------
+bool InlineSourceBuffer::getCode(std::string_view* code) const
+{
+    *code = code_;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+SourceLocation::SourceLocation(SourceBuffer* source, int firstLine, int lastLine, int firstColumn, int lastColumn, Log::Color color) :
+    source_(source),
     firstLine_(firstLine),
     lastLine_(lastLine),
     firstColumn_(firstColumn),
     lastColumn_(lastColumn),
+    firstOffset_(0),
+    lastOffset_(0),
+    resolved_(true),
+    color_(color)
+{
+}
+
+// ----------------------------------------------------------------------------
+SourceLocation::SourceLocation(SourceBuffer* source, int firstOffset, int lastOffset, Log::Color color) :
+    source_(source),
+    firstLine_(0),
+    lastLine_(0),
+    firstColumn_(0),
+    lastColumn_(0),
+    firstOffset_(firstOffset),
+    lastOffset_(lastOffset),
+    resolved_(false),
     color_(color)
 {
 }
 
+// ----------------------------------------------------------------------------
+void SourceLocation::resolve() const
+{
+    if (resolved_)
+        return;
+    resolved_ = true;
+
+    // If the source code is no longer available there is no way to find the
+    // line, so fall back to treating the source as a single line
+    if (!source_->getLineColumn(firstOffset_, &firstLine_, &firstColumn_) ||
+        !source_->getLineColumn(lastOffset_, &lastLine_, &lastColumn_))
+    {
+        firstLine_ = lastLine_ = 1;
+        firstColumn_ = firstOffset_ + 1;
+        lastColumn_ = lastOffset_ + 1;
+    }
+}
+
 // ----------------------------------------------------------------------------
 int SourceLocation::firstLine() const
 {
+    resolve();
     return firstLine_;
 }
 
 // ----------------------------------------------------------------------------
 int SourceLocation::lastLine() const
 {
+    resolve();
     return lastLine_;
 }
 
 // ----------------------------------------------------------------------------
 int SourceLocation::firstColumn() const
 {
+    resolve();
     return firstColumn_;
 }
 
 // ----------------------------------------------------------------------------
 int SourceLocation::lastColumn() const
 {
+    resolve();
     return lastColumn_;
 }
 
@@ -48,14 +199,22 @@ Log::Color SourceLocation::color() const
     return color_;
 }
 
+// ----------------------------------------------------------------------------
+SourceBuffer* SourceLocation::source() const
+{
+    return source_;
+}
+
 // ----------------------------------------------------------------------------
 void SourceLocation::unionize(const SourceLocation* other)
 {
+    resolve();
+
     if (firstLine_ > other->firstLine())
         firstColumn_ = other->firstColumn();
     else if (firstLine_ == other->firstLine())
         if (firstColumn_ > other->firstColumn())
-            firstColumn_ = other->firstColumn_;
+            firstColumn_ = other->firstColumn();
 
     if (lastLine_ < other->lastLine())
         lastColumn_ = other->lastColumn();
@@ -70,8 +229,10 @@ void SourceLocation::unionize(const SourceLocation* other)
 }
 
 // ----------------------------------------------------------------------------
-std::vector<std::string> SourceLocation::getUnderlinedSection(std::istream& code) const
+std::vector<std::string> SourceLocation::getUnderlinedSection() const
 {
+    resolve();
+
     auto retError = [this]() -> std::vector<std::string> {
         return {"(Invalid location " + std::to_string(firstLine_) + ","
                                      + std::to_string(lastLine_) + ","
@@ -79,28 +240,25 @@ std::vector<std::string> SourceLocation::getUnderlinedSection(std::istream& code
                                      + std::to_string(lastColumn_) + ")",
                 ""};
     };
-    // Seek to first line
-    int currentLine = 0;
-    std::string line;
-    while (currentLine < firstLine_)
-    {
-        if (code.eof())
-            return retError();
-        std::getline(code, line);
-        currentLine++;
-    }
 
+    std::string_view line;
+    if (!source_->getLine(1, &line))
+        return {"(source file was removed)"};
+
+    // Only the lines that are shown are looked up
     std::vector<std::string> lines;
-    lines.push_back(line);
+    int currentLine = firstLine_ > 0 ? firstLine_ : 0;
+    if (currentLine > 0 && !source_->getLine(currentLine, &line))
+        return retError();
+    lines.emplace_back(currentLine > 0 ? line : std::string_view());
 
     // Section might span more than one line
     while (currentLine < lastLine_)
     {
-        if (code.eof())
-            return retError();
-        std::getline(code, line);
-        lines.push_back(line);
         currentLine++;
+        if (!source_->getLine(currentLine, &line))
+            return retError();
+        lines.emplace_back(line);
     }
 
     std::vector<std::string> squiggles;
@@ -181,6 +339,8 @@ std::vector<std::string> SourceLocation::getUnderlinedSection(std::istream& code
 // ----------------------------------------------------------------------------
 void SourceLocation::printUnderlinedSection(Log& log) const
 {
+    resolve();
+
     int gutterWidth = (int)std::to_string(lastLine()).length();
     auto sourceHighlightLines = getUnderlinedSection();
     for (int i = 0; i < (int)sourceHighlightLines.size(); i += 2)
@@ -208,76 +368,47 @@ void SourceLocation::printUnderlinedSection(Log& log) const
 // ----------------------------------------------------------------------------
 std::string SourceLocation::getLineColumnExtents() const
 {
+    resolve();
+
     return std::to_string(firstLine_) + "-" + std::to_string(lastLine_) + ":"
          + std::to_string(firstColumn_) + "-" + std::to_string(lastColumn_);
 }
 
 // ----------------------------------------------------------------------------
-FileSourceLocation::FileSourceLocation(const std::string& fileName,
-        int firstLine, int lastLine, int firstColumn, int lastColumn) :
-    SourceLocation(firstLine, lastLine, firstColumn, lastColumn),
-    fileName_(fileName)
+std::string SourceLocation::getFileLineColumn() const
 {
-}
+    resolve();
 
-// ----------------------------------------------------------------------------
-std::string FileSourceLocation::getFileLineColumn() const
-{
-    return fileName_ + ":" + std::to_string(firstLine_) + ":" + std::to_string(firstColumn_);
+    return source_->getName() + ":" + std::to_string(firstLine_) + ":" + std::to_string(firstColumn_);
 }
 
 // ----------------------------------------------------------------------------
-std::vector<std::string> FileSourceLocation::getUnderlinedSection() const
+SourceLocation* SourceLocation::duplicate() const
 {
-    std::ifstream code(fileName_);
-    if (!code.is_open())
-        return {"(source file was removed)"};
-    return SourceLocation::getUnderlinedSection(code);
-}
+    if (!resolved_)
+        return new SourceLocation(source_, firstOffset_, lastOffset_, color_);
 
-// ----------------------------------------------------------------------------
-SourceLocation* FileSourceLocation::duplicate() const
-{
-    return new FileSourceLocation(
-        fileName_,
+    return new SourceLocation(
+        source_,
         firstLine_,
         lastLine_,
         firstColumn_,
-        lastColumn_);
+        lastColumn_,
+        color_);
 }
 
 // ----------------------------------------------------------------------------
-InlineSourceLocation::InlineSourceLocation(const std::string& sourceName, const std::string& code,
+FileSourceLocation::FileSourceLocation(const std::string& fileName,
         int firstLine, int lastLine, int firstColumn, int lastColumn) :
-    SourceLocation(firstLine, lastLine, firstColumn, lastColumn),
-    sourceName_(sourceName),
-    code_(code)
+    SourceLocation(new FileSourceBuffer(fileName), firstLine, lastLine, firstColumn, lastColumn)
 {
 }
 
 // ----------------------------------------------------------------------------
-std::string InlineSourceLocation::getFileLineColumn() const
-{
-    return sourceName_ + ":" + std::to_string(firstLine_) + ":" + std::to_string(firstColumn_);
-}
-
-// ----------------------------------------------------------------------------
-std::vector<std::string> InlineSourceLocation::getUnderlinedSection() const
-{
-    std::stringstream ss(code_);
-    return SourceLocation::getUnderlinedSection(ss);
-}
-
-// ----------------------------------------------------------------------------
-SourceLocation* InlineSourceLocation::duplicate() const
+InlineSourceLocation::InlineSourceLocation(const std::string& sourceName, const std::string& code,
+        int firstLine, int lastLine, int firstColumn, int lastColumn) :
+    SourceLocation(new InlineSourceBuffer(sourceName, code), firstLine, lastLine, firstColumn, lastColumn)
 {
-    return new InlineSourceLocation(
-        sourceName_,
-        code_,
-        firstLine_,
-        lastLine_,
-        firstColumn_,
-        lastColumn_);
 }
 
 }
@@ -10,6 +10,8 @@ Command::Command(PluginInfo* sourceLibrary,
                  Type returnType,
                  const std::vector<Arg>& args,
                  const std::string& helpFile) :
+    // Commands are shared between concurrent compilations via CommandIndex
+    RefCounted(RefCountPolicy::ThreadSafe),
     library_(sourceLibrary),
     dbSymbol_(dbSymbol),
     cppSymbol_(cppSymbol),
@@ -0,0 +1,319 @@
+#include "odb-compiler/commands/CommandCache.hpp"
+#include "odb-compiler/commands/CommandIndex.hpp"
+#include "odb-compiler/parsers/PluginInfo.hpp"
+#include "odb-sdk/Log.hpp"
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace odb {
+namespace cmd {
+
+// Bump this whenever the layout of the cache file changes, or whenever the
+// command loaders change what they extract from a plugin. Otherwise caches
+// written by an older build would still load and give stale commands.
+//   2: Plugins are read by the built-in ELF/PE reader instead of LIEF
+static const char cacheMagic[8] = {'O', 'D', 'B', 'C', 'M', 'D', 'S', '\0'};
+static const std::uint32_t cacheFormatVersion = 2;
+
+namespace {
+
+// ----------------------------------------------------------------------------
+class Writer
+{
+public:
+    void write(const void* data, std::size_t size)
+    {
+        const char* bytes = static_cast<const char*>(data);
+        buffer_.insert(buffer_.end(), bytes, bytes + size);
+    }
+
+    template <typename T>
+    void write(T value) { write(&value, sizeof(value)); }
+
+    void write(const std::string& str)
+    {
+        write<std::uint32_t>((std::uint32_t)str.size());
+        write(str.data(), str.size());
+    }
+
+    const std::vector<char>& buffer() const { return buffer_; }
+
+private:
+    std::vector<char> buffer_;
+};
+
+// ----------------------------------------------------------------------------
+class Reader
+{
+public:
+    Reader(const char* data, std::size_t size) : data_(data), size_(size) {}
+
+    bool read(void* out, std::size_t size)
+    {
+        if (size > size_ - pos_)
+            return false;
+        std::memcpy(out, data_ + pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    template <typename T>
+    bool read(T* value) { return read(static_cast<void*>(value), sizeof(*value)); }
+
+    bool read(std::string* str)
+    {
+        std::uint32_t size;
+        if (!read(&size) || size > size_ - pos_)
+            return false;
+        str->assign(data_ + pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    bool atEnd() const { return pos_ == size_; }
+    std::size_t remaining() const { return size_ - pos_; }
+
+private:
+    const char* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+};
+
+// ----------------------------------------------------------------------------
+bool getFileStamp(const fs::path& path, std::uint64_t* size, std::int64_t* mtime)
+{
+    std::error_code ec;
+    *size = fs::file_size(path, ec);
+    if (ec)
+        return false;
+    *mtime = fs::last_write_time(path, ec).time_since_epoch().count();
+    return !ec;
+}
+
+// ----------------------------------------------------------------------------
+bool hashFile(const fs::path& path, std::uint64_t* hash)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    // 64-bit FNV-1a
+    std::uint64_t h = 14695981039346656037ull;
+    char buffer[65536];
+    while (file)
+    {
+        file.read(buffer, sizeof(buffer));
+        for (std::streamsize i = 0; i != file.gcount(); ++i)
+        {
+            h ^= (unsigned char)buffer[i];
+            h *= 1099511628211ull;
+        }
+    }
+
+    *hash = h;
+    return true;
+}
+
+}
+
+// ----------------------------------------------------------------------------
+CommandCache::CommandCache(const fs::path& cacheFile) :
+    cacheFile_(cacheFile)
+{
+}
+
+// ----------------------------------------------------------------------------
+bool CommandCache::load()
+{
+    entries_.clear();
+
+    std::ifstream file(cacheFile_, std::ios::binary);
+    if (!file.is_open())
+        return false;
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    Reader r(data.data(), data.size());
+    char magic[sizeof(cacheMagic)];
+    std::uint32_t formatVersion, compilerVersion, entryCount;
+    if (!r.read(magic, sizeof(magic)) || std::memcmp(magic, cacheMagic, sizeof(magic)) != 0 ||
+        !r.read(&formatVersion) || formatVersion != cacheFormatVersion ||
+        !r.read(&compilerVersion) || compilerVersion != ODBCOMPILER_VERSION ||
+        !r.read(&entryCount))
+    {
+        Log::sdk(Log::INFO, "Ignoring outdated command cache `%s`\n", cacheFile_.string().c_str());
+        return false;
+    }
+
+    // Counts come from the file, so they are checked against the remaining
+    // data before anything is allocated for them. Every element takes up at
+    // least one byte.
+    auto readEntry = [&r](std::string* path, Entry* entry) -> bool {
+        std::uint32_t commandCount;
+        if (!r.read(path) || !r.read(&entry->size) || !r.read(&entry->mtime) || !r.read(&entry->hash) ||
+            !r.read(&commandCount) || commandCount > r.remaining())
+            return false;
+
+        entry->commands.resize(commandCount);
+        for (auto& command : entry->commands)
+        {
+            std::uint32_t argCount;
+            if (!r.read(&command.dbSymbol) || !r.read(&command.cppSymbol) || !r.read(&command.helpFile) ||
+                !r.read(&command.returnType) || !r.read(&argCount) || argCount > r.remaining())
+                return false;
+
+            command.args.resize(argCount);
+            for (auto& arg : command.args)
+                if (!r.read(&arg.type) || !r.read(&arg.symName) || !r.read(&arg.description))
+                    return false;
+        }
+        return true;
+    };
+
+    auto rejectCorrupt = [this]() -> bool {
+        Log::sdk(Log::WARNING, "Command cache `%s` is corrupt and will be rebuilt\n", cacheFile_.string().c_str());
+        entries_.clear();
+        return false;
+    };
+
+    for (std::uint32_t i = 0; i != entryCount; ++i)
+    {
+        std::string path;
+        Entry entry;
+        if (!readEntry(&path, &entry))
+            return rejectCorrupt();
+        entries_.emplace(std::move(path), std::move(entry));
+    }
+
+    // Trailing data means the entries were not read the way they were written
+    if (!r.atEnd())
+        return rejectCorrupt();
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool CommandCache::save() const
+{
+    Writer w;
+    w.write(cacheMagic, sizeof(cacheMagic));
+    w.write<std::uint32_t>(cacheFormatVersion);
+    w.write<std::uint32_t>(ODBCOMPILER_VERSION);
+
+    std::uint32_t entryCount = 0;
+    for (const auto& [path, entry] : entries_)
+        if (entry.used)
+            entryCount++;
+    w.write<std::uint32_t>(entryCount);
+
+    for (const auto& [path, entry] : entries_)
+    {
+        if (!entry.used)
+            continue;
+
+        w.write(path);
+        w.write(entry.size);
+        w.write(entry.mtime);
+        w.write(entry.hash);
+        w.write<std::uint32_t>((std::uint32_t)entry.commands.size());
+        for (const auto& command : entry.commands)
+        {
+            w.write(command.dbSymbol);
+            w.write(command.cppSymbol);
+            w.write(command.helpFile);
+            w.write(command.returnType);
+            w.write<std::uint32_t>((std::uint32_t)command.args.size());
+            for (const auto& arg : command.args)
+            {
+                w.write(arg.type);
+                w.write(arg.symName);
+                w.write(arg.description);
+            }
+        }
+    }
+
+    // Write to a temporary file first so an interrupted write can't leave a
+    // truncated cache behind
+    std::error_code ec;
+    if (cacheFile_.has_parent_path())
+        fs::create_directories(cacheFile_.parent_path(), ec);
+    fs::path tmpFile = cacheFile_;
+    tmpFile += ".tmp";
+    {
+        std::ofstream file(tmpFile, std::ios::binary);
+        if (!file.is_open())
+        {
+            Log::sdk(Log::WARNING, "Failed to write command cache `%s`\n", tmpFile.string().c_str());
+            return false;
+        }
+        file.write(w.buffer().data(), w.buffer().size());
+        if (!file)
+        {
+            Log::sdk(Log::WARNING, "Failed to write command cache `%s`\n", tmpFile.string().c_str());
+            return false;
+        }
+    }
+    fs::rename(tmpFile, cacheFile_, ec);
+    if (ec)
+    {
+        Log::sdk(Log::WARNING, "Failed to write command cache `%s`: %s\n", cacheFile_.string().c_str(),
+                 ec.message().c_str());
+        fs::remove(tmpFile, ec);
+        return false;
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool CommandCache::lookup(const fs::path& pluginPath, CommandIndex* index)
+{
+    auto it = entries_.find(pluginPath.string());
+    if (it == entries_.end())
+        return false;
+    Entry& entry = it->second;
+
+    std::uint64_t size;
+    std::int64_t mtime;
+    if (!getFileStamp(pluginPath, &size, &mtime) || size != entry.size)
+        return false;
+
+    // The file may have been touched or copied without changing. Fall back
+    // to comparing the contents.
+    if (mtime != entry.mtime)
+    {
+        std::uint64_t hash;
+        if (!hashFile(pluginPath, &hash) || hash != entry.hash)
+            return false;
+        entry.mtime = mtime;
+    }
+
+    Reference<PluginInfo> library = PluginInfo::openDeferred(pluginPath.string());
+    for (const auto& command : entry.commands)
+        index->addCommand(new Command(library, command.dbSymbol, command.cppSymbol, command.returnType, command.args,
+                                      command.helpFile));
+
+    entry.used = true;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+void CommandCache::store(const fs::path& pluginPath, const std::vector<Reference<Command>>& commands)
+{
+    Entry entry;
+    if (!getFileStamp(pluginPath, &entry.size, &entry.mtime) || !hashFile(pluginPath, &entry.hash))
+        return;
+
+    entry.commands.reserve(commands.size());
+    for (const auto& command : commands)
+        entry.commands.push_back({command->dbSymbol(), command->cppSymbol(), command->helpFile(),
+                                  command->returnType(), command->args()});
+
+    entry.used = true;
+    entries_[pluginPath.string()] = std::move(entry);
+}
+
+}
+}
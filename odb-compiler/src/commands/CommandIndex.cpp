@@ -1,9 +1,9 @@
 #include "odb-compiler/commands/CommandIndex.hpp"
 #include "odb-compiler/parsers/PluginInfo.hpp"
 #include "odb-sdk/Log.hpp"
-#include "odb-sdk/Str.hpp"
 
 #include <algorithm>
+#include <cassert>
 #include <cstdio>
 #include <iostream>
 #include <unordered_map>
@@ -12,28 +12,171 @@
 namespace odb {
 namespace cmd {
 
+namespace {
+
+char foldCase(char c)
+{
+    return c >= 'A' && c <= 'Z' ? char(c - 'A' + 'a') : c;
+}
+
+// FNV-1a over the case-folded name, mixed with a seed so the perfect hash can
+// search for a seed per bucket that avoids collisions
+std::uint64_t hashName(std::string_view name, std::uint32_t seed)
+{
+    std::uint64_t h = 14695981039346656037ull ^ (seed * 0x9E3779B97F4A7C15ull);
+    for (char c : name)
+    {
+        h ^= (unsigned char)foldCase(c);
+        h *= 1099511628211ull;
+    }
+    return h ^ (h >> 32);
+}
+
+bool equalsFolded(std::string_view folded, std::string_view name)
+{
+    if (folded.size() != name.size())
+        return false;
+    for (std::size_t i = 0; i != name.size(); ++i)
+        if (folded[i] != foldCase(name[i]))
+            return false;
+    return true;
+}
+
+// The pool stores names folded the same way lookups fold their input, so
+// both sides agree on every byte regardless of the current locale
+std::string foldName(std::string_view name)
+{
+    std::string folded(name);
+    for (char& c : folded)
+        c = foldCase(c);
+    return folded;
+}
+
+}
+
 // ----------------------------------------------------------------------------
 void CommandIndex::addCommand(Command* command)
 {
     commands_.emplace_back(command);
-    commandLookupTable_.emplace(command->dbSymbol(), command);
+    frozen_ = false;
 }
 
 // ----------------------------------------------------------------------------
-bool CommandIndex::findConflicts() const
+void CommandIndex::freeze()
 {
-    std::unordered_map<std::string, std::vector<const Command*>> map_;
+    if (frozen_)
+        return;
 
-    for (const auto& cmd : commands_)
+    namePool_.clear();
+    overloads_.clear();
+    groups_.clear();
+    displacements_.clear();
+    slots_.clear();
+
+    // Group overloads by name, keeping the order they were added in
+    std::vector<std::vector<const Command*>> overloadsByGroup;
+    {
+        std::unordered_map<std::string, std::uint32_t> groupIndices;
+        for (const auto& command : commands_)
+        {
+            auto [it, inserted] = groupIndices.emplace(foldName(command->dbSymbol()), std::uint32_t(groups_.size()));
+            if (inserted)
+            {
+                groups_.push_back({std::uint32_t(namePool_.size()), std::uint32_t(it->first.size()), 0, 0});
+                namePool_ += it->first;
+                overloadsByGroup.emplace_back();
+            }
+            overloadsByGroup[it->second].push_back(command);
+        }
+    }
+
+    overloads_.reserve(commands_.size());
+    for (std::size_t i = 0; i != groups_.size(); ++i)
+    {
+        groups_[i].firstOverload = std::uint32_t(overloads_.size());
+        groups_[i].overloadCount = std::uint32_t(overloadsByGroup[i].size());
+        overloads_.insert(overloads_.end(), overloadsByGroup[i].begin(), overloadsByGroup[i].end());
+    }
+
+    // Build a perfect hash using "hash and displace": Names are distributed
+    // into buckets by a first hash. Starting with the largest bucket, search
+    // for a seed that places every name of the bucket into a free slot.
+    auto groupName = [this](std::uint32_t group) -> std::string_view {
+        return std::string_view(namePool_).substr(groups_[group].nameOffset, groups_[group].nameLength);
+    };
+
+    const std::size_t groupCount = groups_.size();
+    if (groupCount > 0)
     {
-        auto it = map_.insert({str::toLower(cmd->dbSymbol()), {cmd}});
-        if (it.second)
-            continue;
+        const std::size_t bucketCount = groupCount / 2 + 1;
+        std::vector<std::vector<std::uint32_t>> buckets(bucketCount);
+        for (std::uint32_t group = 0; group != groupCount; ++group)
+            buckets[hashName(groupName(group), 0) % bucketCount].push_back(group);
 
-        // This dbSymbol already exists. Have to compare the new command with
-        // all overloads of the existing symbol
-        for (const auto& overload : it.first->second)
+        std::vector<std::size_t> bucketOrder(bucketCount);
+        for (std::size_t i = 0; i != bucketCount; ++i)
+            bucketOrder[i] = i;
+        std::stable_sort(bucketOrder.begin(), bucketOrder.end(),
+                         [&buckets](std::size_t a, std::size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+        for (std::size_t slotCount = groupCount + groupCount / 4 + 1;; slotCount *= 2)
         {
+            slots_.assign(slotCount, 0);
+            displacements_.assign(bucketCount, 0);
+
+            bool success = true;
+            std::vector<std::size_t> placed;
+            for (std::size_t bucket : bucketOrder)
+            {
+                if (buckets[bucket].empty())
+                    break;
+
+                std::uint32_t seed = 1;
+                for (; seed < (1u << 16); ++seed)
+                {
+                    placed.clear();
+                    for (std::uint32_t group : buckets[bucket])
+                    {
+                        std::size_t slot = hashName(groupName(group), seed) % slotCount;
+                        if (slots_[slot] != 0)
+                            break;
+                        slots_[slot] = group + 1;
+                        placed.push_back(slot);
+                    }
+                    if (placed.size() == buckets[bucket].size())
+                        break;
+                    for (std::size_t slot : placed)
+                        slots_[slot] = 0;
+                }
+
+                if (seed == (1u << 16))
+                {
+                    success = false;
+                    break;
+                }
+                displacements_[bucket] = seed;
+            }
+
+            if (success)
+                break;
+        }
+    }
+
+    frozen_ = true;
+}
+
+// ----------------------------------------------------------------------------
+bool CommandIndex::findConflicts() const
+{
+    for (const auto& cmd : commands_)
+    {
+        // Have to compare the command with all overloads of the same symbol
+        // that were added before it
+        for (const Command* overload : lookup(cmd->dbSymbol()))
+        {
+            if (overload == cmd.get())
+                break;
+
             auto compare = [](const Command* a, const Command* b) -> bool {
                 // Compare each argument type
                 for (std::size_t i = 0; i != a->args().size() && i != b->args().size(); ++i)
@@ -72,16 +215,23 @@ bool CommandIndex::findConflicts() const
 }
 
 // ----------------------------------------------------------------------------
-std::vector<Reference<Command>> CommandIndex::lookup(std::string commandName) const
+CommandIndex::OverloadSet CommandIndex::lookup(std::string_view commandName) const
 {
-    std::transform(commandName.begin(), commandName.end(), commandName.begin(),
-                   [](char c) { return std::tolower(c); });
-    std::vector<Reference<Command>> matches;
-    auto overloadIteratorRange = commandLookupTable_.equal_range(commandName);
-    for (auto match = overloadIteratorRange.first; match != overloadIteratorRange.second; ++match) {
-        matches.emplace_back(match->second);
-    }
-    return matches;
+    assert(frozen_);
+    if (groups_.empty())
+        return {};
+
+    std::uint32_t seed = displacements_[hashName(commandName, 0) % displacements_.size()];
+    std::uint32_t slot = slots_[hashName(commandName, seed) % slots_.size()];
+    if (slot == 0)
+        return {};
+
+    const OverloadGroup& group = groups_[slot - 1];
+    if (!equalsFolded(std::string_view(namePool_).substr(group.nameOffset, group.nameLength), commandName))
+        return {};
+
+    const Command* const* first = overloads_.data() + group.firstOverload;
+    return {first, first + group.overloadCount};
 }
 
 // ----------------------------------------------------------------------------
@@ -1,15 +1,113 @@
 #include "odb-compiler/commands/CommandLoader.hpp"
+#include "odb-compiler/commands/CommandCache.hpp"
+#include "odb-compiler/commands/CommandIndex.hpp"
+#include "odb-compiler/parsers/PluginInfo.hpp"
+#include "odb-sdk/Log.hpp"
+#include "odb-sdk/Reference.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace fs = std::filesystem;
 
 namespace odb {
 namespace cmd {
 
 // ----------------------------------------------------------------------------
-CommandLoader::CommandLoader(const std::filesystem::path& sdkRoot,
-                             const std::vector<std::filesystem::path>& pluginDirs) :
+CommandLoader::CommandLoader(const fs::path& sdkRoot,
+                             const std::vector<fs::path>& pluginDirs) :
     sdkRoot_(sdkRoot),
     pluginDirs_(pluginDirs)
 {
 }
 
+// ----------------------------------------------------------------------------
+void CommandLoader::setCommandCache(CommandCache* cache)
+{
+    cache_ = cache;
+}
+
+// ----------------------------------------------------------------------------
+bool CommandLoader::populateIndexFromPlugins(CommandIndex* index, const std::vector<fs::path>& plugins)
+{
+    // Plugins are merged into the index in path order so the result, and any
+    // conflicts reported for it, don't depend on directory iteration order or
+    // on which thread finishes first
+    std::vector<fs::path> sortedPlugins = plugins;
+    std::sort(sortedPlugins.begin(), sortedPlugins.end());
+    sortedPlugins.erase(std::unique(sortedPlugins.begin(), sortedPlugins.end()), sortedPlugins.end());
+
+    struct PluginCommands
+    {
+        CommandIndex index;
+        ThreadLogBuffer log;
+        bool parsed = false;
+    };
+    std::vector<PluginCommands> results(sortedPlugins.size());
+
+    // The cache isn't thread safe, so look everything up before parsing
+    std::vector<std::size_t> pluginsToParse;
+    for (std::size_t i = 0; i != sortedPlugins.size(); ++i)
+        if (cache_ == nullptr || !cache_->lookup(sortedPlugins[i], &results[i].index))
+            pluginsToParse.push_back(i);
+
+    // Parsing a plugin is CPU bound and independent of all other plugins.
+    // Each worker only touches the results of the plugins it claims, and
+    // collects its messages so they can be printed in path order below.
+    std::atomic<std::size_t> nextPlugin = 0;
+    std::atomic<bool> failed = false;
+    auto parsePlugins = [&]() {
+        for (std::size_t n; !failed && (n = nextPlugin++) < pluginsToParse.size();)
+        {
+            PluginCommands& result = results[pluginsToParse[n]];
+            result.log.begin();
+
+            // A file that can't be opened as a plugin has already been
+            // reported. Plugin directories may contain other libraries, so
+            // this isn't fatal and the file is skipped.
+            Reference<PluginInfo> lib = PluginInfo::open(sortedPlugins[pluginsToParse[n]].string());
+            if (lib != nullptr)
+            {
+                if (!populateIndexFromLibrary(&result.index, lib))
+                    failed = true;
+                result.parsed = true;
+
+                // Commands keep a reference to their library, but only need
+                // its path and name from here on
+                lib->releaseImage();
+            }
+
+            result.log.end();
+        }
+    };
+
+    std::size_t threadCount = std::min<std::size_t>(
+        std::max(1u, std::thread::hardware_concurrency()), pluginsToParse.size());
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(parsePlugins);
+    parsePlugins();
+    for (auto& thread : threads)
+        thread.join();
+
+    for (std::size_t i = 0; i != sortedPlugins.size(); ++i)
+    {
+        results[i].log.flush(Log::info);
+        if (failed)
+            continue;
+
+        if (cache_ && results[i].parsed)
+            cache_->store(sortedPlugins[i], results[i].index.commands());
+        for (const auto& command : results[i].index.commands())
+            index->addCommand(command);
+    }
+
+    if (failed)
+        return false;
+
+    index->freeze();
+    return true;
+}
+
 }
 }
@@ -2,8 +2,7 @@
 #include "odb-compiler/commands/CommandIndex.hpp"
 #include "odb-sdk/Str.hpp"
 #include <algorithm>
-#include <iostream>
-#include <cstring>
+#include <cctype>
 
 namespace odb {
 namespace cmd {
@@ -27,20 +26,53 @@ void CommandMatcher::updateFromIndex(const CommandIndex* db)
 {
     longestCommandLength_ = 0;
     longestCommandWordCount_ = 0;
-    commands_ = db->commandNamesAsList();
+    nodes_.clear();
+    edges_.clear();
+
+    std::vector<std::string> commands = db->commandNamesAsList();
 
     // Commands are case insensitive, so transform all to lower case
-    for (auto& s : commands_)
+    for (auto& s : commands)
         str::toLowerInplace(s);
 
-    // Lexicographic sort so we can binary search later
-    std::sort(commands_.begin(), commands_.end(), [](const std::string& a,const  std::string& b) { return a < b; });
+    // Lexicographic sort so the trie can be built in a single pass
+    std::sort(commands.begin(), commands.end());
+
+    // Because the commands are sorted, a node's child for a given character
+    // can only ever be the most recently added one, and children end up being
+    // sorted by character.
+    std::vector<std::vector<Edge>> children(1);
+    std::vector<bool> isCommand(1, false);
+    for (const auto& command : commands)
+    {
+        int node = 0;
+        for (char c : command)
+        {
+            if (children[node].empty() || children[node].back().c != c)
+            {
+                children[node].push_back({c, (int)children.size()});
+                children.emplace_back();
+                isCommand.push_back(false);
+            }
+            node = children[node].back().node;
+        }
+        isCommand[node] = true;
+    }
+
+    // Flatten into contiguous arrays
+    nodes_.resize(children.size());
+    for (std::size_t i = 0; i != children.size(); ++i)
+    {
+        nodes_[i].firstEdge = (int)edges_.size();
+        nodes_[i].edgeCount = (int)children[i].size();
+        nodes_[i].isCommand = isCommand[i];
+        edges_.insert(edges_.end(), children[i].begin(), children[i].end());
+    }
 
-    // Find the longest command so the lexicographic comparison is faster during
-    // binary search
-    auto longestCommand = std::max_element(commands_.begin(), commands_.end(),
+    // Find the longest command. Useful for preallocating buffers.
+    auto longestCommand = std::max_element(commands.begin(), commands.end(),
             [](const std::string& a, const std::string& b) { return a.size() < b.size(); });
-    if (longestCommand != commands_.end())
+    if (longestCommand != commands.end())
         longestCommandLength_ = (int)longestCommand->size();
 
     // Find the maximum number of words that appear in a command. This is not
@@ -49,46 +81,85 @@ void CommandMatcher::updateFromIndex(const CommandIndex* db)
     auto wordCount = [](const std::string& str) {
         return std::count(str.begin(), str.end(), ' ') + 1;
     };
-    auto longestCommandWordCount = std::max_element(commands_.begin(), commands_.end(),
+    auto longestCommandWordCount = std::max_element(commands.begin(), commands.end(),
             [&wordCount](const std::string& a, const std::string& b) {
                 return wordCount(a) < wordCount(b);
             });
-    if (longestCommandWordCount != commands_.end())
+    if (longestCommandWordCount != commands.end())
         longestCommandWordCount_ = (int)wordCount(*longestCommandWordCount);
 }
 
+// ----------------------------------------------------------------------------
+int CommandMatcher::findChild(int node, char c) const
+{
+    // Commands are sorted as std::string, which compares bytes as unsigned
+    // char, so edges have to be searched the same way
+    unsigned char lower = (unsigned char)std::tolower((unsigned char)c);
+    auto first = edges_.begin() + nodes_[node].firstEdge;
+    auto last = first + nodes_[node].edgeCount;
+    auto edge = std::lower_bound(first, last, lower,
+        [](const Edge& e, unsigned char c) { return (unsigned char)e.c < c; });
+    if (edge == last || (unsigned char)edge->c != lower)
+        return -1;
+    return edge->node;
+}
+
 // ----------------------------------------------------------------------------
 CommandMatcher::MatchResult CommandMatcher::findLongestCommandMatching(const std::string& str) const
 {
-    auto first = commands_.begin();
-    auto last = commands_.end();
-    std::vector<std::vector<std::string>::const_iterator> commandStack;
-    commandStack.reserve(longestCommandWordCount());
+    if (nodes_.empty())
+        return { 0, false };
+
+    int node = 0;
     int matchedLen = 0;
+    int longestCommandLen = -1;
     while (str[matchedLen])
     {
-        auto compare = [&](const std::string& a, const std::string& b) {
-            return std::tolower(a[matchedLen]) < std::tolower(b[matchedLen]);
-        };
-        first = std::lower_bound(first, last, str, compare);
-        last = std::upper_bound(first, last, str, compare);
-        if (first == last)
+        node = findChild(node, str[matchedLen]);
+        if (node < 0)
             break;
 
         ++matchedLen;
-        if (!charIsSymbolToken(str[matchedLen]))
-            commandStack.push_back(first);
+
+        // Only accept a command if it isn't immediately followed by more
+        // characters of the same symbol, e.g. "dec" must not match "decalmax"
+        if (nodes_[node].isCommand && !charIsSymbolToken(str[matchedLen]))
+            longestCommandLen = matchedLen;
     }
 
-    while (commandStack.size())
+    if (longestCommandLen >= 0)
+        return { longestCommandLen, true };
+
+    return { matchedLen, false };
+}
+
+// ----------------------------------------------------------------------------
+CommandMatcher::MatchState CommandMatcher::beginMatch() const
+{
+    MatchState state;
+    state.node = nodes_.empty() ? -1 : 0;
+    return state;
+}
+
+// ----------------------------------------------------------------------------
+bool CommandMatcher::continueMatch(MatchState& state, const char* str, int len) const
+{
+    for (int i = 0; i != len && state.node >= 0; ++i)
     {
-        auto command = commandStack.back();
-        if (command != commands_.end() && str::strncicmp(str.c_str(), command->c_str(), command->length()) == 0)
-            return { (int)command->length(), true };
-        commandStack.pop_back();
+        int next = findChild(state.node, str[i]);
+        if (next < 0)
+        {
+            state.node = -1;
+            state.found = false;
+            break;
+        }
+
+        state.node = next;
+        state.matchedLength++;
+        state.found = nodes_[next].isCommand;
     }
 
-    return { matchedLen, false };
+    return state.node >= 0;
 }
 
 // ----------------------------------------------------------------------------
@@ -52,17 +52,7 @@ bool DBPCommandLoader::populateIndex(CommandIndex* index)
                 pluginsToLoad.emplace_back(p.path());
     }
 
-    for (const auto& path : pluginsToLoad)
-    {
-        Reference<PluginInfo> lib = PluginInfo::open(path.string());
-        if (lib == nullptr)
-            continue;
-
-        if (!populateIndexFromLibrary(index, lib))
-            return false;
-    }
-
-    return true;
+    return populateIndexFromPlugins(index, pluginsToLoad);
 }
 
 // ----------------------------------------------------------------------------
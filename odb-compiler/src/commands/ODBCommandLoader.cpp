@@ -115,24 +115,14 @@ bool ODBCommandLoader::populateIndex(CommandIndex* index)
                 pluginsToLoad.emplace_back(p.path());
     }
 
-    for (const auto& path : pluginsToLoad)
-    {
-        Reference<PluginInfo> lib = PluginInfo::open(path.string());
-        if (lib == nullptr)
-            continue;
-
-        if (!populateIndexFromLibrary(index, lib))
-            return false;
-    }
-
-    return true;
+    return populateIndexFromPlugins(index, pluginsToLoad);
 }
 
 // ----------------------------------------------------------------------------
 bool ODBCommandLoader::populateIndexFromLibrary(CommandIndex* index, PluginInfo* library)
 {
     auto lookupString = [&library](const std::string& sym) -> std::string {
-        return library->lookupStringBySymbol(sym).value_or("");
+        return std::string(library->lookupStringBySymbol(sym).value_or(""));
     };
 
     size_t symbolCount = library->getSymbolCount();
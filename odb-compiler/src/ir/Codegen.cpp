@@ -4,14 +4,159 @@
 #include "codegen/DBPEngineInterface.hpp"
 #include "codegen/LLVM.hpp"
 #include "codegen/ODBEngineInterface.hpp"
+#include "odb-compiler/parsers/PluginInfo.hpp"
+#include "odb-sdk/DynamicLibrary.hpp"
+#include "odb-sdk/Reference.hpp"
+#include "odb-sdk/ScopedPhase.hpp"
+#include "odb-sdk/TimeReport.hpp"
 
 #include <iostream>
+#include <unordered_map>
 
 #include <reproc++/run.hpp>
 
 namespace odb::ir {
-bool generateCode(SDKType sdkType, OutputType outputType, TargetTriple targetTriple, std::ostream& output,
-                  const std::string& moduleName, Program& program, const cmd::CommandIndex& cmdIndex)
+namespace {
+void initLLVMBackends()
+{
+    static std::once_flag initLLVMBackendsFlag;
+    std::call_once(initLLVMBackendsFlag,
+                   []
+                   {
+                       LLVMInitializeX86TargetInfo();
+                       LLVMInitializeX86Target();
+                       LLVMInitializeX86TargetMC();
+                       LLVMInitializeX86AsmPrinter();
+                       LLVMInitializeAArch64TargetInfo();
+                       LLVMInitializeAArch64Target();
+                       LLVMInitializeAArch64TargetMC();
+                       LLVMInitializeAArch64AsmPrinter();
+                   });
+}
+
+llvm::CodeGenOpt::Level getCodeGenOptLevel(OptimizationLevel optLevel)
+{
+    switch (optLevel)
+    {
+    case OptimizationLevel::O0:
+        return llvm::CodeGenOpt::None;
+    case OptimizationLevel::O1:
+        return llvm::CodeGenOpt::Less;
+    case OptimizationLevel::O2:
+    case OptimizationLevel::Os:
+        return llvm::CodeGenOpt::Default;
+    case OptimizationLevel::O3:
+        return llvm::CodeGenOpt::Aggressive;
+    }
+    return llvm::CodeGenOpt::Default;
+}
+
+// Feeds the time LLVM spends in each pass and analysis into the time report. Pass managers and adaptors only wrap
+// other passes, so they are left out to avoid counting the same time twice.
+void registerPassTimers(llvm::PassInstrumentationCallbacks& callbacks,
+                        std::vector<TimeReport::Clock::time_point>& startTimes)
+{
+    static const std::vector<llvm::StringRef> wrapperPasses = {"PassManager", "PassAdaptor", "AnalysisManagerProxy",
+                                                               "DevirtSCCRepeatedPass", "ModuleInlinerWrapperPass"};
+    auto start = [&startTimes](llvm::StringRef pass, llvm::Any)
+    {
+        if (!llvm::isSpecialPass(pass, wrapperPasses))
+            startTimes.push_back(TimeReport::Clock::now());
+    };
+    auto stop = [&startTimes](llvm::StringRef pass)
+    {
+        if (llvm::isSpecialPass(pass, wrapperPasses) || startTimes.empty())
+            return;
+        TimeReport::addEvent("llvm", pass.str(), startTimes.back(), TimeReport::Clock::now());
+        startTimes.pop_back();
+    };
+
+    callbacks.registerBeforeNonSkippedPassCallback(start);
+    callbacks.registerAfterPassCallback([stop](llvm::StringRef pass, llvm::Any, const llvm::PreservedAnalyses&)
+                                        { stop(pass); });
+    callbacks.registerAfterPassInvalidatedCallback([stop](llvm::StringRef pass, const llvm::PreservedAnalyses&)
+                                                   { stop(pass); });
+    callbacks.registerBeforeAnalysisCallback(start);
+    callbacks.registerAfterAnalysisCallback([stop](llvm::StringRef pass, llvm::Any) { stop(pass); });
+}
+
+void optimizeModule(llvm::Module& module, llvm::TargetMachine& targetMachine, OptimizationLevel optLevel)
+{
+    ScopedPhase phase("optimizeModule");
+
+    llvm::OptimizationLevel llvmOptLevel;
+    switch (optLevel)
+    {
+    case OptimizationLevel::O0:
+        llvmOptLevel = llvm::OptimizationLevel::O0;
+        break;
+    case OptimizationLevel::O1:
+        llvmOptLevel = llvm::OptimizationLevel::O1;
+        break;
+    case OptimizationLevel::O2:
+        llvmOptLevel = llvm::OptimizationLevel::O2;
+        break;
+    case OptimizationLevel::O3:
+        llvmOptLevel = llvm::OptimizationLevel::O3;
+        break;
+    case OptimizationLevel::Os:
+        llvmOptLevel = llvm::OptimizationLevel::Os;
+        break;
+    }
+
+    // The analysis managers refer to the instrumentation, so it has to outlive them.
+    llvm::PassInstrumentationCallbacks instrumentation;
+    std::vector<TimeReport::Clock::time_point> passStartTimes;
+    if (TimeReport::enabled())
+    {
+        registerPassTimers(instrumentation, passStartTimes);
+    }
+
+    // The analysis managers must be declared in this order so that they are destroyed in the correct order.
+    llvm::LoopAnalysisManager lam;
+    llvm::FunctionAnalysisManager fam;
+    llvm::CGSCCAnalysisManager cgam;
+    llvm::ModuleAnalysisManager mam;
+
+    llvm::PipelineTuningOptions tuningOptions;
+    tuningOptions.LoopUnrolling = optLevel != OptimizationLevel::O0 && optLevel != OptimizationLevel::Os;
+    tuningOptions.LoopVectorization = optLevel == OptimizationLevel::O2 || optLevel == OptimizationLevel::O3;
+    tuningOptions.SLPVectorization = optLevel == OptimizationLevel::O2 || optLevel == OptimizationLevel::O3;
+
+    llvm::PassBuilder passBuilder(&targetMachine, tuningOptions, llvm::None, &instrumentation);
+    passBuilder.registerModuleAnalyses(mam);
+    passBuilder.registerCGSCCAnalyses(cgam);
+    passBuilder.registerFunctionAnalyses(fam);
+    passBuilder.registerLoopAnalyses(lam);
+    passBuilder.crossRegisterProxies(lam, fam, cgam, mam);
+
+    llvm::ModulePassManager mpm = optLevel == OptimizationLevel::O0
+                                      ? passBuilder.buildO0DefaultPipeline(llvmOptLevel)
+                                      : passBuilder.buildPerModuleDefaultPipeline(llvmOptLevel);
+    mpm.run(module, mam);
+}
+} // namespace
+
+TargetMachineCache::TargetMachineCache() = default;
+TargetMachineCache::~TargetMachineCache() = default;
+
+llvm::TargetMachine* TargetMachineCache::find(const std::string& llvmTargetTriple, OptimizationLevel optLevel) const
+{
+    auto it = targetMachines_.find({llvmTargetTriple, optLevel});
+    return it != targetMachines_.end() ? it->second.get() : nullptr;
+}
+
+llvm::TargetMachine* TargetMachineCache::insert(const std::string& llvmTargetTriple, OptimizationLevel optLevel,
+                                                std::unique_ptr<llvm::TargetMachine> targetMachine)
+{
+    auto& entry = targetMachines_[{llvmTargetTriple, optLevel}];
+    entry = std::move(targetMachine);
+    return entry.get();
+}
+
+bool generateCode(SDKType sdkType, OutputType outputType, OptimizationLevel optLevel, TargetTriple targetTriple,
+                  std::ostream& output, const std::string& moduleName, Program& program,
+                  const cmd::CommandIndex& cmdIndex, TargetMachineCache* targetMachines)
 {
     llvm::LLVMContext context;
     llvm::Module module(moduleName, context);
@@ -38,6 +183,48 @@ bool generateCode(SDKType sdkType, OutputType outputType, TargetTriple targetTri
         }
     }
 
+    initLLVMBackends();
+
+    // Lookup target machine. This is needed even when emitting LLVM IR or Bitcode, as the optimizer relies on the
+    // data layout and target specific cost model.
+    std::string llvmTargetTriple = targetTriple.getLLVMTargetTriple();
+    if (sdkType == SDKType::DarkBASIC)
+    {
+        // Only the i386-pc-windows-msvc target triple is supported.
+        if (targetTriple.arch != TargetTriple::Arch::i386 || targetTriple.platform != TargetTriple::Platform::Windows)
+        {
+            Log::info.print(
+                "Unsupported platform and arch. Only i386 on Windows is supported when working with the DBP SDK type.");
+            return false;
+        }
+    }
+    std::unique_ptr<llvm::TargetMachine> ownedTargetMachine;
+    llvm::TargetMachine* targetMachine = targetMachines ? targetMachines->find(llvmTargetTriple, optLevel) : nullptr;
+    if (!targetMachine)
+    {
+        std::string error;
+        const llvm::Target* target = llvm::TargetRegistry::lookupTarget(llvmTargetTriple, error);
+        if (!target)
+        {
+            Log::info.print("Unknown target triple: %s", error.c_str());
+            return false;
+        }
+
+        auto cpu = "generic";
+        auto features = "";
+        llvm::TargetOptions opt;
+        ownedTargetMachine.reset(target->createTargetMachine(
+            llvmTargetTriple, cpu, features, opt, {}, {}, getCodeGenOptLevel(optLevel)));
+        targetMachine = targetMachines
+                            ? targetMachines->insert(llvmTargetTriple, optLevel, std::move(ownedTargetMachine))
+                            : ownedTargetMachine.get();
+    }
+    module.setDataLayout(targetMachine->createDataLayout());
+    module.setTargetTriple(llvmTargetTriple);
+
+    // Run the optimization pipeline.
+    optimizeModule(module, *targetMachine, optLevel);
+
     // If we are emitting LLVM IR or Bitcode, return early.
     if (outputType == OutputType::LLVMIR)
     {
@@ -54,69 +241,154 @@ bool generateCode(SDKType sdkType, OutputType outputType, TargetTriple targetTri
 
     assert(outputType == OutputType::ObjectFile);
 
-    static std::once_flag initLLVMBackendsFlag;
-    auto initLLVMBackends = []
-    {
-      LLVMInitializeX86TargetInfo();
-      LLVMInitializeX86Target();
-      LLVMInitializeX86TargetMC();
-      LLVMInitializeX86AsmPrinter();
-      LLVMInitializeAArch64TargetInfo();
-      LLVMInitializeAArch64Target();
-      LLVMInitializeAArch64TargetMC();
-      LLVMInitializeAArch64AsmPrinter();
-    };
-    std::call_once(initLLVMBackendsFlag, initLLVMBackends);
+    llvm::SmallVector<char, 0> outputFileBuffer;
 
-    // Lookup target machine.
-    std::string llvmTargetTriple = targetTriple.getLLVMTargetTriple();
-    if (sdkType == SDKType::DarkBASIC)
+    // Emit object file to buffer.
     {
-        // Only the i386-pc-windows-msvc target triple is supported.
-        if (targetTriple.arch != TargetTriple::Arch::i386 || targetTriple.platform != TargetTriple::Platform::Windows)
+        ScopedPhase phase("emitObject");
+        llvm::raw_svector_ostream objectFileStream(outputFileBuffer);
+        llvm::legacy::PassManager pass;
+        if (targetMachine->addPassesToEmitFile(pass, objectFileStream, nullptr, llvm::CGFT_ObjectFile))
         {
-            Log::info.print(
-                "Unsupported platform and arch. Only i386 on Windows is supported when working with the DBP SDK type.");
+            Log::info.print("llvm::TargetMachine can't emit a file of this type");
             return false;
         }
+        pass.run(module);
     }
-    std::string error;
-    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(llvmTargetTriple, error);
-    if (!target)
+
+    // Flush buffer to stream.
+    output.write(outputFileBuffer.data(), outputFileBuffer.size());
+    output.flush();
+
+    return true;
+}
+
+bool runProgram(SDKType sdkType, OptimizationLevel optLevel, const std::string& moduleName, Program& program,
+                const cmd::CommandIndex& cmdIndex, int& exitCode)
+{
+    if (sdkType != SDKType::ODB)
     {
-        Log::info.print("Unknown target triple: %s", error.c_str());
+        Log::codegen(Log::ERROR, "Running a program in-process is only supported for the ODB SDK.\n");
         return false;
     }
 
-    auto cpu = "generic";
-    auto features = "";
-    llvm::TargetOptions opt;
-    llvm::TargetMachine* targetMachine = target->createTargetMachine(llvmTargetTriple, cpu, features, opt, {});
-    module.setDataLayout(targetMachine->createDataLayout());
-    module.setTargetTriple(llvmTargetTriple);
+    auto context = std::make_unique<llvm::LLVMContext>();
+    auto module = std::make_unique<llvm::Module>(moduleName, *context);
 
-    llvm::SmallVector<char, 0> outputFileBuffer;
+    // Generate the module. The engine interface records which plugin symbol each external command function refers to.
+    ODBEngineInterface engineInterface(*module);
+    {
+        CodeGenerator gen(*module, engineInterface);
+        if (!gen.generateModule(program, cmdIndex.librariesAsList()))
+        {
+            return false;
+        }
+    }
 
-    // Emit object file to buffer.
-    llvm::raw_svector_ostream objectFileStream(outputFileBuffer);
-    llvm::legacy::PassManager pass;
-    if (targetMachine->addPassesToEmitFile(pass, objectFileStream, nullptr, llvm::CGFT_ObjectFile))
+    initLLVMBackends();
+
+    // Create a target machine for the host and optimize the module with it.
+    auto targetMachineBuilder = llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!targetMachineBuilder)
     {
-        Log::info.print("llvm::TargetMachine can't emit a file of this type");
+        Log::codegen(Log::ERROR, "Failed to detect host target: %s\n",
+                     llvm::toString(targetMachineBuilder.takeError()).c_str());
         return false;
     }
-    pass.run(module);
+    targetMachineBuilder->setCodeGenOptLevel(getCodeGenOptLevel(optLevel));
+    auto targetMachine = targetMachineBuilder->createTargetMachine();
+    if (!targetMachine)
+    {
+        Log::codegen(Log::ERROR, "Failed to create target machine: %s\n",
+                     llvm::toString(targetMachine.takeError()).c_str());
+        return false;
+    }
+    module->setDataLayout((*targetMachine)->createDataLayout());
+    module->setTargetTriple((*targetMachine)->getTargetTriple().str());
+    optimizeModule(*module, **targetMachine, optLevel);
 
-    // Flush buffer to stream.
-    output.write(outputFileBuffer.data(), outputFileBuffer.size());
-    output.flush();
+    auto jit = llvm::orc::LLJITBuilder().setJITTargetMachineBuilder(std::move(*targetMachineBuilder)).create();
+    if (!jit)
+    {
+        Log::codegen(Log::ERROR, "Failed to create JIT: %s\n", llvm::toString(jit.takeError()).c_str());
+        return false;
+    }
+
+    // Load the plugins and bind every command function directly to its symbol. The libraries must stay loaded until
+    // the program has finished running.
+    std::unordered_map<std::string, Reference<DynamicLibrary>> plugins;
+    llvm::orc::SymbolMap commandSymbols;
+    bool missingSymbols = false;
+    for (const auto& [functionName, command] : engineInterface.commandFunctions())
+    {
+        const PluginInfo* pluginInfo = command->library();
+        auto plugin = plugins.find(pluginInfo->getPath());
+        if (plugin == plugins.end())
+        {
+            Reference<DynamicLibrary> library = DynamicLibrary::open(pluginInfo->getPath());
+            if (library == nullptr)
+            {
+                Log::codegen(Log::ERROR, "Failed to load plugin `%s`\n", pluginInfo->getPath());
+                return false;
+            }
+            plugin = plugins.emplace(pluginInfo->getPath(), library).first;
+        }
 
+        void* address = plugin->second->lookupSymbolAddress(command->cppSymbol().c_str());
+        if (address == nullptr)
+        {
+            Log::codegen(Log::ERROR, "Failed to find symbol `%s` in plugin `%s`\n", command->cppSymbol().c_str(),
+                         pluginInfo->getPath());
+            missingSymbols = true;
+            continue;
+        }
+        commandSymbols[(*jit)->mangleAndIntern(functionName)] =
+            llvm::JITEvaluatedSymbol(llvm::pointerToJITTargetAddress(address), llvm::JITSymbolFlags::Exported);
+    }
+    if (missingSymbols)
+    {
+        return false;
+    }
+
+    // Anything else (e.g. memcpy emitted by the optimizer) is resolved from the current process.
+    llvm::orc::JITDylib& mainDylib = (*jit)->getMainJITDylib();
+    auto processSymbols =
+        llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess((*jit)->getDataLayout().getGlobalPrefix());
+    if (!processSymbols)
+    {
+        Log::codegen(Log::ERROR, "%s\n", llvm::toString(processSymbols.takeError()).c_str());
+        return false;
+    }
+    mainDylib.addGenerator(std::move(*processSymbols));
+
+    if (auto error = mainDylib.define(llvm::orc::absoluteSymbols(std::move(commandSymbols))))
+    {
+        Log::codegen(Log::ERROR, "%s\n", llvm::toString(std::move(error)).c_str());
+        return false;
+    }
+    if (auto error = (*jit)->addIRModule(llvm::orc::ThreadSafeModule(std::move(module), std::move(context))))
+    {
+        Log::codegen(Log::ERROR, "%s\n", llvm::toString(std::move(error)).c_str());
+        return false;
+    }
+
+    auto mainSymbol = (*jit)->lookup("main");
+    if (!mainSymbol)
+    {
+        Log::codegen(Log::ERROR, "%s\n", llvm::toString(mainSymbol.takeError()).c_str());
+        return false;
+    }
+
+    auto* mainFunc = reinterpret_cast<int (*)()>(static_cast<std::uintptr_t>(mainSymbol->getAddress()));
+    exitCode = mainFunc();
     return true;
 }
 
 bool linkExecutable(SDKType sdkType, const std::filesystem::path& sdkRootDir, const std::filesystem::path& linker,
                     TargetTriple targetTriple, std::vector<std::string> inputFilenames, std::string& outputFilename)
 {
+    ScopedPhase phase("linkExecutable");
+
     std::vector<std::string> args;
     args.emplace_back(linker.string());
 
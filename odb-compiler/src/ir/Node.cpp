@@ -1,4 +1,5 @@
 #include "odb-compiler/ir/Node.hpp"
+#include "odb-sdk/MemReport.hpp"
 
 #include <algorithm>
 #include <cassert>
@@ -130,11 +131,35 @@ SourceLocation* Node::location() const
     return location_;
 }
 
+void* Node::operator new(std::size_t size)
+{
+    MemReport::track(MemCategory::IRNode, size);
+    return ::operator new(size);
+}
+
+void Node::operator delete(void* p, std::size_t size)
+{
+    MemReport::untrack(MemCategory::IRNode, size);
+    ::operator delete(p);
+}
+
 Variable::Variable(SourceLocation* location, std::string name, Annotation annotation, Type type)
     : Node(location), name_(std::move(name)), annotation_(annotation), type_(type)
 {
 }
 
+void* Variable::operator new(std::size_t size)
+{
+    MemReport::track(MemCategory::IRVariable, size);
+    return Node::operator new(size);
+}
+
+void Variable::operator delete(void* p, std::size_t size)
+{
+    MemReport::untrack(MemCategory::IRVariable, size);
+    Node::operator delete(p, size);
+}
+
 const std::string& Variable::name() const
 {
     return name_;
@@ -1,8 +1,10 @@
 #include "odb-compiler/ir/SemanticChecker.hpp"
 #include "semantic/ASTConverter.hpp"
+#include "odb-sdk/ScopedPhase.hpp"
 
 namespace odb::ir {
 Ptr<Program> runSemanticChecks(const ast::Block* ast, const cmd::CommandIndex& cmdIndex) {
+    ScopedPhase phase("runSemanticChecks");
     return ASTConverter(cmdIndex).generateProgram(ast);
 }
 }
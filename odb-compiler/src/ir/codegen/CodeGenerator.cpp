@@ -1,4 +1,7 @@
 #include "CodeGenerator.hpp"
+#include "odb-sdk/MemReport.hpp"
+#include "odb-sdk/ScopedPhase.hpp"
+#include "odb-sdk/TimeReport.hpp"
 
 namespace odb::ir {
 namespace {
@@ -771,6 +774,8 @@ llvm::Function* CodeGenerator::generateFunctionPrototype(const FunctionDefinitio
 void CodeGenerator::generateFunctionBody(llvm::Function* function, const FunctionDefinition& irFunction,
                                          bool isMainFunction)
 {
+    ScopedTimer timer("function", irFunction.name());
+
     auto& symtab = *symbolTables[function];
 
     auto* initialBlock = llvm::BasicBlock::Create(ctx, "entry", function);
@@ -832,51 +837,84 @@ void CodeGenerator::generateFunctionBody(llvm::Function* function, const Functio
 
 bool CodeGenerator::generateModule(const Program& program, std::vector<PluginInfo*> pluginsToLoad)
 {
-    GlobalSymbolTable globalSymbolTable(module, engineInterface);
+    // Generation and verification are reported as separate phases, so the
+    // generation phase is closed before the module is verified
+    {
+        ScopedPhase phase("generateModule");
 
-    gosubStackType = llvm::ArrayType::get(llvm::Type::getInt8PtrTy(ctx), 32);
-    generateGosubHelperFunctions();
+        GlobalSymbolTable globalSymbolTable(module, engineInterface);
 
-    // Generate main function.
-    llvm::Function* gameEntryPointFunc = generateFunctionPrototype(program.mainFunction());
-    symbolTables.emplace(gameEntryPointFunc, std::make_unique<SymbolTable>(gameEntryPointFunc, globalSymbolTable));
+        gosubStackType = llvm::ArrayType::get(llvm::Type::getInt8PtrTy(ctx), 32);
+        generateGosubHelperFunctions();
 
-    // Generate user defined functions.
-    for (const auto& function : program.functions())
-    {
-        llvm::Function* llvmFunc = generateFunctionPrototype(*function);
-        globalSymbolTable.addFunctionToTable(*function, llvmFunc);
-        symbolTables.emplace(llvmFunc, std::make_unique<SymbolTable>(llvmFunc, globalSymbolTable));
-    }
+        // Generate main function.
+        llvm::Function* gameEntryPointFunc = generateFunctionPrototype(program.mainFunction());
+        symbolTables.emplace(gameEntryPointFunc, std::make_unique<SymbolTable>(gameEntryPointFunc, globalSymbolTable));
 
-    // Generate function bodies.
-    generateFunctionBody(gameEntryPointFunc, program.mainFunction(), true);
-    for (const auto& function : program.functions())
-    {
-        generateFunctionBody(globalSymbolTable.getFunction(*function), *function, false);
-    }
+        // Generate user defined functions.
+        for (const auto& function : program.functions())
+        {
+            llvm::Function* llvmFunc = generateFunctionPrototype(*function);
+            globalSymbolTable.addFunctionToTable(*function, llvmFunc);
+            symbolTables.emplace(llvmFunc, std::make_unique<SymbolTable>(llvmFunc, globalSymbolTable));
+        }
+
+        // Generate function bodies.
+        generateFunctionBody(gameEntryPointFunc, program.mainFunction(), true);
+        for (const auto& function : program.functions())
+        {
+            generateFunctionBody(globalSymbolTable.getFunction(*function), *function, false);
+        }
 
-    // Generate executable entry point that initialises the DBP engine and calls the games entry
-    // point.
-    engineInterface.generateEntryPoint(gameEntryPointFunc, std::move(pluginsToLoad));
+        // Generate executable entry point that initialises the DBP engine and calls the games entry
+        // point.
+        engineInterface.generateEntryPoint(gameEntryPointFunc, std::move(pluginsToLoad));
+    }
 
     // #ifndef NDEBUG
     //     module.print(llvm::errs(), nullptr);
     // #endif
 
     // Verify module.
-    bool brokenDebugInfo;
-    std::string verifyResultBuffer;
-    llvm::raw_string_ostream verifyResultStream{verifyResultBuffer};
-    if (llvm::verifyModule(module, &verifyResultStream, &brokenDebugInfo))
     {
-        Log::codegen(Log::Severity::FATAL, "Failed to verify LLVM module: %s.", verifyResultBuffer.c_str());
-        return false;
+        ScopedPhase phase("verifyModule");
+        bool brokenDebugInfo;
+        std::string verifyResultBuffer;
+        llvm::raw_string_ostream verifyResultStream{verifyResultBuffer};
+        if (llvm::verifyModule(module, &verifyResultStream, &brokenDebugInfo))
+        {
+            Log::codegen(Log::Severity::FATAL, "Failed to verify LLVM module: %s.", verifyResultBuffer.c_str());
+            return false;
+        }
+    }
+
+    if (MemReport::enabled())
+    {
+        countInstructions();
     }
 
     return true;
 }
 
+void CodeGenerator::countInstructions()
+{
+    // LLVM doesn't say how much memory an instruction takes, so estimate it from its operands
+    std::size_t count = 0;
+    std::size_t bytes = 0;
+    for (const llvm::Function& function : module)
+    {
+        for (const llvm::BasicBlock& block : function)
+        {
+            for (const llvm::Instruction& instruction : block)
+            {
+                count++;
+                bytes += sizeof(llvm::Instruction) + instruction.getNumOperands() * sizeof(llvm::Use);
+            }
+        }
+    }
+    MemReport::addCreated(MemCategory::LLVMInstruction, count, bytes);
+}
+
 void CodeGenerator::generateGosubHelperFunctions()
 {
     llvm::IRBuilder<> builder{ctx};
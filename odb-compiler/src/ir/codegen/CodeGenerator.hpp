@@ -95,6 +95,7 @@ private:
     llvm::Function* gosubPopAddress;
 
     void generateGosubHelperFunctions();
+    void countInstructions();
     void printString(llvm::IRBuilder<>& builder, llvm::Value* string);
 };
 } // namespace odb::ir
@@ -55,10 +55,14 @@ llvm::Function* DBPEngineInterface::generateCommandCall(const cmd::Command& comm
     llvm::FunctionType* pluginFunctionType =
         llvm::FunctionType::get(pluginReturnType, functionType->params(), functionType->isVarArg());
 
-    // Obtain function ptr from the relevant plugin.
-    // TODO: Call this once at the beginning of the application.
-    auto commandFunction =
-        getPluginFunction(builder, pluginFunctionType, command.library(), command.cppSymbol(), functionName + "Symbol");
+    // The function ptr is resolved once in the entry point, so all we need to do here is load it.
+    auto* functionPtr = new llvm::GlobalVariable(module, pluginFunctionType->getPointerTo(), false,
+                                                 llvm::GlobalValue::InternalLinkage,
+                                                 llvm::ConstantPointerNull::get(pluginFunctionType->getPointerTo()),
+                                                 functionName + "Ptr");
+    commandAddresses.push_back({command.library(), command.cppSymbol(), functionName, pluginFunctionType, functionPtr});
+    llvm::FunctionCallee commandFunction(pluginFunctionType,
+                                         builder.CreateLoad(functionPtr->getValueType(), functionPtr));
 
     //    printString(builder, builder.CreateGlobalStringPtr("Calling " + functionName));
 
@@ -138,10 +142,16 @@ void DBPEngineInterface::generateEntryPoint(llvm::Function* gameEntryPoint, std:
     {
         pluginLoadingBlocks.emplace_back(llvm::BasicBlock::Create(ctx, "load" + std::string{plugin->getName()}, entryPointFunc));
     }
+    llvm::BasicBlock* resolveCommandsBlock = llvm::BasicBlock::Create(ctx, "resolveCommands", entryPointFunc);
+    llvm::BasicBlock* checkCommandsBlock = llvm::BasicBlock::Create(ctx, "checkCommands", entryPointFunc);
     llvm::BasicBlock* initialiseEngineBlock = llvm::BasicBlock::Create(ctx, "initialiseEngine", entryPointFunc);
     llvm::BasicBlock* failedToInitialiseEngineBlock = llvm::BasicBlock::Create(ctx, "failedToInitialiseEngine", entryPointFunc);
     llvm::BasicBlock* launchGameBlock = llvm::BasicBlock::Create(ctx, "launchGame", entryPointFunc);
     
+    // Flag that is set if any command could not be resolved.
+    builder.SetInsertPoint(pluginLoadingBlocks[0]);
+    llvm::Value* missingCommandsPtr = builder.CreateAlloca(llvm::Type::getInt1Ty(ctx), nullptr, "missingCommands");
+
     // Load plugins.
     for (std::size_t i = 0; i < pluginsToLoad.size(); ++i)
     {
@@ -159,11 +169,42 @@ void DBPEngineInterface::generateEntryPoint(llvm::Function* gameEntryPoint, std:
         builder.CreateStore(libraryHandle, getOrAddPluginHandleVar(plugin));
 
         // Check if loaded successfully.
-        auto* nextBlock = i == (pluginsToLoad.size() - 1) ? initialiseEngineBlock : pluginLoadingBlocks[i + 1];
+        auto* nextBlock = i == (pluginsToLoad.size() - 1) ? resolveCommandsBlock : pluginLoadingBlocks[i + 1];
         builder.CreateCondBr(builder.CreateICmpNE(libraryHandle, llvm::ConstantPointerNull::get(voidPtrTy)),
                              nextBlock, failedToInitialiseEngineBlock);
     }
 
+    // Resolve the address of every command used by the program. Missing symbols are all reported before failing, so
+    // that a mismatched set of plugins can be diagnosed in one go.
+    builder.SetInsertPoint(resolveCommandsBlock);
+    builder.CreateStore(llvm::ConstantInt::getFalse(ctx), missingCommandsPtr);
+    for (const auto& command : commandAddresses)
+    {
+        llvm::Value* functionAddress = getPluginFunction(builder, command.functionType, command.library, command.symbol,
+                                                         command.functionName + "Symbol");
+        builder.CreateStore(functionAddress, command.functionPtr);
+
+        llvm::BasicBlock* missingCommandBlock =
+            llvm::BasicBlock::Create(ctx, "missing" + command.functionName, entryPointFunc, checkCommandsBlock);
+        llvm::BasicBlock* nextCommandBlock =
+            llvm::BasicBlock::Create(ctx, "resolved" + command.functionName, entryPointFunc, checkCommandsBlock);
+        builder.CreateCondBr(builder.CreateIsNull(functionAddress), missingCommandBlock, nextCommandBlock);
+
+        builder.SetInsertPoint(missingCommandBlock);
+        generatePrintf(builder, "Failed to find symbol `%s` in plugin `%s`\n",
+                       builder.CreateGlobalStringPtr(command.symbol),
+                       builder.CreateGlobalStringPtr(command.library->getName()));
+        builder.CreateStore(llvm::ConstantInt::getTrue(ctx), missingCommandsPtr);
+        builder.CreateBr(nextCommandBlock);
+
+        builder.SetInsertPoint(nextCommandBlock);
+    }
+    builder.CreateBr(checkCommandsBlock);
+
+    builder.SetInsertPoint(checkCommandsBlock);
+    builder.CreateCondBr(builder.CreateLoad(llvm::Type::getInt1Ty(ctx), missingCommandsPtr),
+                         failedToInitialiseEngineBlock, initialiseEngineBlock);
+
     // Initialise engine.
     builder.SetInsertPoint(initialiseEngineBlock);
     auto* initialiseEngineResult = builder.CreateCall(initialiseEngineFunc, {});
@@ -195,13 +236,13 @@ llvm::Value* DBPEngineInterface::getOrAddPluginHandleVar(const PluginInfo* plugi
     return pluginHandle;
 }
 
-llvm::FunctionCallee DBPEngineInterface::getPluginFunction(llvm::IRBuilder<>& builder, llvm::FunctionType* functionTy,
-                                                           const PluginInfo* library, const std::string& symbol,
-                                                           const std::string& symbolStringName)
+llvm::Value* DBPEngineInterface::getPluginFunction(llvm::IRBuilder<>& builder, llvm::FunctionType* functionTy,
+                                                   const PluginInfo* library, const std::string& symbol,
+                                                   const std::string& symbolStringName)
 {
     llvm::Value* pluginHandle = builder.CreateLoad(getOrAddPluginHandleVar(library));
     llvm::CallInst* procAddress =
         builder.CreateCall(getFunctionAddressFunc, {pluginHandle, builder.CreateGlobalStringPtr(symbol, symbolStringName)});
-    return llvm::FunctionCallee(functionTy, builder.CreateBitCast(procAddress, functionTy->getPointerTo()));
+    return builder.CreateBitCast(procAddress, functionTy->getPointerTo());
 }
 } // namespace odb::ir
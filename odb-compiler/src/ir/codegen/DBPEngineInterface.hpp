@@ -25,10 +25,22 @@ private:
 
     std::unordered_map<std::string, llvm::Value*> pluginHandlePtrs;
 
+    // Every command used by the program gets a function pointer global, which is resolved once in the entry point
+    // after all plugins are loaded.
+    struct CommandAddress
+    {
+        const PluginInfo* library;
+        std::string symbol;
+        std::string functionName;
+        llvm::FunctionType* functionType;
+        llvm::GlobalVariable* functionPtr;
+    };
+    std::vector<CommandAddress> commandAddresses;
+
     llvm::Value* getOrAddPluginHandleVar(const PluginInfo* plugin);
-    llvm::FunctionCallee getPluginFunction(llvm::IRBuilder<>& builder, llvm::FunctionType* functionTy,
-                                           const PluginInfo* library, const std::string& symbol,
-                                           const std::string& symbolStringName = "");
+    llvm::Value* getPluginFunction(llvm::IRBuilder<>& builder, llvm::FunctionType* functionTy,
+                                   const PluginInfo* library, const std::string& symbol,
+                                   const std::string& symbolStringName = "");
 
     template <typename... T>
     void generatePrintf(llvm::IRBuilder<>& builder, const std::string& string, T*... params)
@@ -12,6 +12,7 @@ ODBEngineInterface::ODBEngineInterface(llvm::Module& module) : EngineInterface(m
 llvm::Function* ODBEngineInterface::generateCommandCall(const cmd::Command& command, const std::string& functionName,
                                                         llvm::FunctionType* functionType)
 {
+    commandFunctions_.emplace(functionName, &command);
     return llvm::Function::Create(functionType, llvm::Function::ExternalLinkage, functionName, module);
 }
 
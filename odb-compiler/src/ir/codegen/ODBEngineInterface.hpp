@@ -1,6 +1,7 @@
 #pragma once
 
 #include "EngineInterface.hpp"
+#include <unordered_map>
 
 namespace odb::ir {
 class ODBEngineInterface : public EngineInterface
@@ -11,5 +12,12 @@ public:
     llvm::Function* generateCommandCall(const cmd::Command& command, const std::string& functionName,
                                         llvm::FunctionType* functionType) override;
     void generateEntryPoint(llvm::Function* gameEntryPoint, std::vector<PluginInfo*> pluginsToLoad) override;
+
+    // Maps the name of each external command function to the command it calls. This is used to bind the functions
+    // to the plugin symbols when running the module in-process.
+    const std::unordered_map<std::string, const cmd::Command*>& commandFunctions() const { return commandFunctions_; }
+
+private:
+    std::unordered_map<std::string, const cmd::Command*> commandFunctions_;
 };
 } // namespace odb::ir
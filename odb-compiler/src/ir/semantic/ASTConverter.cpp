@@ -191,115 +191,169 @@ Ptr<Expression> ASTConverter::ensureType(Ptr<Expression> expression, Type target
     return expression;
 }
 
-FunctionCallExpression ASTConverter::convertCommandCallExpression(ast::SourceLocation* location,
-                                                                  const std::string& commandName,
-                                                                  const MaybeNull<ast::ArgList>& astArgs)
+std::size_t ASTConverter::OverloadKeyHash::operator()(const OverloadKey& key) const
 {
-    // Extract arguments.
-    PtrVector<Expression> args;
-    if (astArgs.notNull())
+    std::size_t hash = std::hash<const void*>{}(key.overloads);
+    for (const Type& type : key.argTypes)
     {
-        for (ast::Expression* argExpr : astArgs->expressions())
-        {
-            args.emplace_back(convertExpression(argExpr));
-        }
+        std::size_t typeHash = type.isUDT()           ? std::hash<const void*>{}(*type.getUDT())
+                               : type.isBuiltinType() ? std::size_t(*type.getBuiltinType()) + 1
+                                                      : 0;
+        hash ^= typeHash + 0x9e3779b9 + (hash << 6) + (hash >> 2);
     }
+    return hash;
+}
+
+bool ASTConverter::OverloadKey::operator==(const OverloadKey& other) const
+{
+    return overloads == other.overloads && argTypes == other.argTypes;
+}
 
-    auto candidates = cmdIndex_.lookup(commandName);
-    const cmd::Command* command = candidates.front();
+ASTConverter::OverloadResolution ASTConverter::resolveOverload(SourceLocation* location,
+                                                               const std::string& commandName,
+                                                               cmd::CommandIndex::OverloadSet overloads,
+                                                               const std::vector<Type>& argTypes)
+{
+    const cmd::Command* command = overloads.front();
 
     // If a command is overloaded, then we will need to perform overload resolution.
-    if (candidates.size() > 1)
+    if (overloads.size() > 1)
     {
-        // Remove candidates which don't have the correct number of arguments.
-        candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
-                                        [&](const Reference<cmd::Command>& candidate)
-                                        { return candidate->args().size() != args.size(); }),
-                         candidates.end());
-
-        // Remove candidates where arguments can not be converted.
-        auto convertArgumentsNotPossiblePrecondition = [&](const Reference<cmd::Command>& candidate) -> bool
+        // Candidates need the correct number of arguments, and all arguments have to be convertible.
+        auto isViable = [&](const cmd::Command* candidate) -> bool
         {
+            if (candidate->args().size() != argTypes.size())
+            {
+                return false;
+            }
             for (std::size_t i = 0; i < candidate->args().size(); ++i)
             {
                 auto candidateArgCommandType = candidate->args()[i].type;
                 if (candidateArgCommandType == cmd::Command::Type{'X'} ||
                     candidateArgCommandType == cmd::Command::Type{'A'})
                 {
-                    return true;
+                    return false;
                 }
-                if (!isTypeConvertible(args[i]->getType(), getTypeFromCommandType(candidateArgCommandType)))
+                if (!isTypeConvertible(argTypes[i], getTypeFromCommandType(candidateArgCommandType)))
                 {
-                    return true;
+                    return false;
                 }
             }
-            return false;
+            return true;
         };
-        candidates.erase(std::remove_if(candidates.begin(), candidates.end(), convertArgumentsNotPossiblePrecondition),
-                         candidates.end());
-
-        if (candidates.empty())
-        {
-            fatalError(location, "Unable to find matching overload for command '%s'.", commandName.c_str());
-        }
 
-        // Sort candidates in ascending order by how suitable they are. The candidate at the end of the sorted list is
-        // the best match.
-        auto candidateRankFunction = [&](const Reference<cmd::Command>& candidateA,
-                                         const Reference<cmd::Command>& candidateB) -> bool
+        // The candidate scoring function generates a score for a particular overload.
+        // The goal should be that the best matching function should have the highest score.
+        // The algorithm works as follows:
+        // * Each argument contributes to the score. Various attributes add a certain score:
+        //   * Exact match: +10
+        //   * Same "archetype" (i.e. integers, floats): +1
+        //
+        // The result should be: We should prefer the overload with exactly the same argument. If it's not
+        // exactly the same, then we should prefer the one with the same archetype. This means, if we have
+        // a function "foo" with a int32 and double overload, and we call it with an int64 parameter,
+        // the int32 overload should be preferred over the double. However, if we call it with a float
+        // parameter, the double overload should be preferred.
+        auto scoreCandidate = [&](const cmd::Command* overload) -> int
         {
-            // The candidate scoring function generates a score for a particular overload.
-            // The goal should be that the best matching function should have the highest score.
-            // The algorithm works as follows:
-            // * Each argument contributes to the score. Various attributes add a certain score:
-            //   * Exact match: +10
-            //   * Same "archetype" (i.e. integers, floats): +1
-            //
-            // The result should be: We should prefer the overload with exactly the same argument. If it's not
-            // exactly the same, then we should prefer the one with the same archetype. This means, if we have
-            // a function "foo" with a int32 and double overload, and we call it with an int64 parameter,
-            // the int32 overload should be preferred over the double. However, if we call it with a float
-            // parameter, the double overload should be preferred.
-            auto scoreCandidate = [&](const Reference<cmd::Command>& overload) -> int
+            int score = 0;
+            for (std::size_t i = 0; i < overload->args().size(); ++i)
             {
-                int score = 0;
-                for (std::size_t i = 0; i < overload->args().size(); ++i)
+                auto overloadType = getTypeFromCommandType(overload->args()[i].type);
+                const Type& argType = argTypes[i];
+                if (overloadType == argType)
                 {
-                    auto overloadType = getTypeFromCommandType(overload->args()[i].type);
-                    auto argType = args[i]->getType();
-                    if (overloadType == argType)
+                    score += 10;
+                }
+                else if (overloadType.isBuiltinType() && argType.isBuiltinType())
+                {
+                    if (isIntegralType(*overloadType.getBuiltinType()) && isIntegralType(*argType.getBuiltinType()))
                     {
-                        score += 10;
+                        score += 1;
                     }
-                    else if (overloadType.isBuiltinType() && argType.isBuiltinType())
+                    if (isFloatingPointType(*overloadType.getBuiltinType()) &&
+                        isFloatingPointType(*argType.getBuiltinType()))
                     {
-                        if (isIntegralType(*overloadType.getBuiltinType()) && isIntegralType(*argType.getBuiltinType()))
-                        {
-                            score += 1;
-                        }
-                        if (isFloatingPointType(*overloadType.getBuiltinType()) &&
-                            isFloatingPointType(*argType.getBuiltinType()))
-                        {
-                            score += 1;
-                        }
+                        score += 1;
                     }
                 }
-                return score;
-            };
-            return scoreCandidate(candidateA) < scoreCandidate(candidateB);
+            }
+            return score;
         };
-        std::sort(candidates.begin(), candidates.end(), candidateRankFunction);
-        command = candidates.back();
+
+        // Pick the viable candidate with the highest score. If several candidates score the same, the one that was
+        // added to the command index first wins.
+        command = nullptr;
+        int bestScore = -1;
+        for (const cmd::Command* candidate : overloads)
+        {
+            if (!isViable(candidate))
+            {
+                continue;
+            }
+            int score = scoreCandidate(candidate);
+            if (score > bestScore)
+            {
+                command = candidate;
+                bestScore = score;
+            }
+        }
+
+        if (command == nullptr)
+        {
+            fatalError(location, "Unable to find matching overload for command '%s'.", commandName.c_str());
+        }
+    }
+
+    OverloadResolution resolution{command, {}, getTypeFromCommandType(command->returnType())};
+    resolution.argTypes.reserve(command->args().size());
+    for (const auto& arg : command->args())
+    {
+        resolution.argTypes.push_back(getTypeFromCommandType(arg.type));
+    }
+    return resolution;
+}
+
+FunctionCallExpression ASTConverter::convertCommandCallExpression(ast::SourceLocation* location,
+                                                                  const std::string& commandName,
+                                                                  const MaybeNull<ast::ArgList>& astArgs)
+{
+    // Extract arguments.
+    PtrVector<Expression> args;
+    if (astArgs.notNull())
+    {
+        for (ast::Expression* argExpr : astArgs->expressions())
+        {
+            args.emplace_back(convertExpression(argExpr));
+        }
+    }
+
+    // Programs call the same commands with the same argument types over and over again, so remember which overload
+    // each combination resolved to.
+    auto overloads = cmdIndex_.lookup(commandName);
+    OverloadKey key{overloads.begin(), {}};
+    key.argTypes.reserve(args.size());
+    for (const auto& arg : args)
+    {
+        key.argTypes.push_back(arg->getType());
+    }
+
+    auto resolution = overloadCache_.find(key);
+    if (resolution == overloadCache_.end())
+    {
+        OverloadResolution newResolution = resolveOverload(location, commandName, overloads, key.argTypes);
+        resolution = overloadCache_.emplace(std::move(key), std::move(newResolution)).first;
     }
+    const OverloadResolution& overload = resolution->second;
 
     // Now we have selected an overload, we may need to insert cast operations when passing arguments (in case the
     // overload is not perfect). Do that now.
-    for (std::size_t i = 0; i < args.size(); ++i)
+    for (std::size_t i = 0; i < args.size() && i < overload.argTypes.size(); ++i)
     {
-        args[i] = ensureType(std::move(args[i]), getTypeFromCommandType(command->args()[i].type));
+        args[i] = ensureType(std::move(args[i]), overload.argTypes[i]);
     }
 
-    return FunctionCallExpression{location, command, std::move(args), getTypeFromCommandType(command->returnType())};
+    return FunctionCallExpression{location, overload.command, std::move(args), overload.returnType};
 }
 
 FunctionCallExpression ASTConverter::convertFunctionCallExpression(ast::SourceLocation* location,
@@ -4,11 +4,13 @@
 #include "odb-compiler/ast/FuncDecl.hpp"
 #include "odb-compiler/ast/Symbol.hpp"
 #include "odb-compiler/ast/VarRef.hpp"
+#include "odb-compiler/commands/CommandIndex.hpp"
 #include "odb-compiler/ir/Node.hpp"
 
 #include <array>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace odb::ir {
 class ASTConverter
@@ -25,8 +27,29 @@ public:
     std::unique_ptr<Program> generateProgram(const ast::Block* ast);
 
 private:
+    // Key for memoizing overload resolution. Overload sets are identified by the address of their first entry in
+    // the (frozen) command index.
+    struct OverloadKey
+    {
+        const cmd::Command* const* overloads;
+        std::vector<Type> argTypes;
+
+        bool operator==(const OverloadKey& other) const;
+    };
+    struct OverloadKeyHash
+    {
+        std::size_t operator()(const OverloadKey& key) const;
+    };
+    struct OverloadResolution
+    {
+        const cmd::Command* command;
+        std::vector<Type> argTypes;
+        Type returnType;
+    };
+
     const cmd::CommandIndex& cmdIndex_;
     std::unordered_map<std::string, Function> functionMap_;
+    std::unordered_map<OverloadKey, OverloadResolution, OverloadKeyHash> overloadCache_;
 
     bool errorOccurred_;
 
@@ -66,6 +89,8 @@ private:
     Ptr<Expression> ensureType(Ptr<Expression> expression, Type targetType);
     Reference<Variable> resolveVariableRef(const ast::VarRef* varRef);
 
+    OverloadResolution resolveOverload(SourceLocation* location, const std::string& commandName,
+                                       cmd::CommandIndex::OverloadSet overloads, const std::vector<Type>& argTypes);
     FunctionCallExpression convertCommandCallExpression(SourceLocation* location, const std::string& commandName,
                                                         const MaybeNull<ast::ArgList>& astArgs);
     FunctionCallExpression convertFunctionCallExpression(SourceLocation* location, ast::AnnotatedSymbol* symbol,
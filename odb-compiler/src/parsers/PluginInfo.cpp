@@ -1,119 +1,548 @@
 #include "odb-compiler/parsers/PluginInfo.hpp"
 #include "odb-sdk/Log.hpp"
+#include "odb-sdk/MappedFile.hpp"
 
-#include <LIEF/LIEF.hpp>
-#include <codecvt>
-#include <utility>
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
+#include <unordered_map>
+#include <utility>
 
 namespace odb {
-PluginInfo::~PluginInfo() = default;
 
-Reference<PluginInfo> PluginInfo::open(const std::string& path)
+// The fields we need from ELF and PE headers are read straight out of the
+// mapped file. Only little endian images are supported, which covers every
+// target either SDK runs on.
+namespace {
+
+template <typename T>
+bool read(std::string_view data, std::uint64_t offset, T* value)
 {
-    try
+    if (offset > data.size() || sizeof(T) > data.size() - offset)
+        return false;
+    std::memcpy(value, data.data() + offset, sizeof(T));
+    return true;
+}
+
+std::string_view readCString(std::string_view data, std::uint64_t offset)
+{
+    if (offset >= data.size())
+        return {};
+    data = data.substr(offset);
+    return data.substr(0, data.find('\0'));
+}
+
+void appendUTF8(std::string* out, std::uint32_t c)
+{
+    if (c < 0x80)
+        out->push_back(char(c));
+    else if (c < 0x800)
     {
-        return new PluginInfo(LIEF::Parser::parse(path), path);
+        out->push_back(char(0xC0 | (c >> 6)));
+        out->push_back(char(0x80 | (c & 0x3F)));
     }
-    catch (const LIEF::exception& err)
+    else if (c < 0x10000)
     {
-        Log::codegen(Log::ERROR, "Failed to open plugin %s: %s", path.c_str(), err.what());
+        out->push_back(char(0xE0 | (c >> 12)));
+        out->push_back(char(0x80 | ((c >> 6) & 0x3F)));
+        out->push_back(char(0x80 | (c & 0x3F)));
+    }
+    else
+    {
+        out->push_back(char(0xF0 | (c >> 18)));
+        out->push_back(char(0x80 | ((c >> 12) & 0x3F)));
+        out->push_back(char(0x80 | ((c >> 6) & 0x3F)));
+        out->push_back(char(0x80 | (c & 0x3F)));
+    }
+}
+
+std::string utf16ToUTF8(std::string_view data, std::uint64_t offset, std::uint16_t length)
+{
+    std::string result;
+    result.reserve(length);
+    for (std::uint16_t i = 0; i < length; ++i)
+    {
+        std::uint16_t c;
+        read(data, offset + i * 2u, &c);
+        if (c >= 0xD800 && c < 0xDC00 && i + 1 < length)
+        {
+            std::uint16_t low;
+            read(data, offset + (i + 1) * 2u, &low);
+            if (low >= 0xDC00 && low < 0xE000)
+            {
+                appendUTF8(&result, 0x10000 + ((std::uint32_t(c) - 0xD800) << 10) + (low - 0xDC00));
+                ++i;
+                continue;
+            }
+        }
+        appendUTF8(&result, c);
+    }
+    return result;
+}
+
+}
+
+struct PluginImage
+{
+    enum class Format
+    {
+        ELF,
+        PE
+    };
+
+    struct Section
+    {
+        std::uint64_t virtualAddress;
+        std::uint64_t fileOffset;
+        std::uint64_t fileSize;
+    };
+
+    struct Symbol
+    {
+        std::uint64_t value;
+        std::uint64_t size;
+    };
+
+    bool parse();
+    bool parseELF();
+    bool parsePE();
+    std::optional<std::string_view> contentAt(std::uint64_t address) const;
+
+    Reference<MappedFile> file;
+    std::string_view data;
+    Format format;
+    std::uint64_t imageBase = 0;
+    unsigned pointerSize = 8;
+    std::uint32_t resourceDirectory = 0;
+    std::vector<Section> sections;
+    std::vector<std::string_view> symbolNames;
+    std::unordered_map<std::string_view, Symbol> symbols;
+};
+
+// ----------------------------------------------------------------------------
+bool PluginImage::parse()
+{
+    if (data.substr(0, 4) == std::string_view("\x7f" "ELF", 4))
+        return parseELF();
+    if (data.substr(0, 2) == "MZ")
+        return parsePE();
+    return false;
+}
+
+// ----------------------------------------------------------------------------
+bool PluginImage::parseELF()
+{
+    format = Format::ELF;
+
+    std::uint8_t elfClass, elfData;
+    if (!read(data, 4, &elfClass) || !read(data, 5, &elfData) || elfData != 1 /* ELFDATA2LSB */)
+        return false;
+    if (elfClass != 1 /* ELFCLASS32 */ && elfClass != 2 /* ELFCLASS64 */)
+        return false;
+    const bool is64 = elfClass == 2;
+
+    std::uint64_t shoff;
+    std::uint16_t shentsize, shnum;
+    if (is64)
+    {
+        if (!read(data, 0x28, &shoff) || !read(data, 0x3A, &shentsize) || !read(data, 0x3C, &shnum))
+            return false;
+    }
+    else
+    {
+        std::uint32_t shoff32;
+        if (!read(data, 0x20, &shoff32) || !read(data, 0x2E, &shentsize) || !read(data, 0x30, &shnum))
+            return false;
+        shoff = shoff32;
+    }
+
+    struct SectionHeader
+    {
+        std::uint32_t type = 0;
+        std::uint64_t addr = 0;
+        std::uint64_t offset = 0;
+        std::uint64_t size = 0;
+        std::uint32_t link = 0;
+        std::uint64_t entsize = 0;
+    };
+    std::vector<SectionHeader> headers(shnum);
+    for (std::uint16_t i = 0; i != shnum; ++i)
+    {
+        SectionHeader& h = headers[i];
+        std::uint64_t base = shoff + std::uint64_t(i) * shentsize;
+        if (is64)
+        {
+            if (!read(data, base + 4, &h.type) || !read(data, base + 16, &h.addr) ||
+                !read(data, base + 24, &h.offset) || !read(data, base + 32, &h.size) ||
+                !read(data, base + 40, &h.link) || !read(data, base + 56, &h.entsize))
+                return false;
+        }
+        else
+        {
+            std::uint32_t addr, offset, size, entsize;
+            if (!read(data, base + 4, &h.type) || !read(data, base + 12, &addr) ||
+                !read(data, base + 16, &offset) || !read(data, base + 20, &size) ||
+                !read(data, base + 24, &h.link) || !read(data, base + 36, &entsize))
+                return false;
+            h = {h.type, addr, offset, size, h.link, entsize};
+        }
+
+        if (h.type != 8 /* SHT_NOBITS */ && h.addr != 0)
+            sections.push_back({h.addr, h.offset, h.size});
+    }
+
+    // Only the dynamic symbol table is needed, the plugin's commands have to
+    // be exported
+    for (const auto& h : headers)
+    {
+        if (h.type != 11 /* SHT_DYNSYM */ || h.link >= headers.size())
+            continue;
+
+        // Entries must at least hold an Elf32_Sym/Elf64_Sym record
+        if (h.entsize < (is64 ? 24 : 16) || h.offset > data.size())
+            return false;
+
+        const SectionHeader& strtab = headers[h.link];
+        if (strtab.offset > data.size())
+            return false;
+        std::string_view strings = data.substr(strtab.offset, strtab.size);
+
+        // Don't trust the section size when reserving memory, the table can't
+        // hold more entries than there are bytes left in the file
+        std::uint64_t count = std::min<std::uint64_t>(h.size, data.size() - h.offset) / h.entsize;
+        symbolNames.reserve(count);
+        symbols.reserve(count);
+        for (std::uint64_t i = 0; i != count; ++i)
+        {
+            std::uint64_t base = h.offset + i * h.entsize;
+            std::uint32_t name;
+            Symbol symbol;
+            if (is64)
+            {
+                if (!read(data, base, &name) || !read(data, base + 8, &symbol.value) ||
+                    !read(data, base + 16, &symbol.size))
+                    return false;
+            }
+            else
+            {
+                std::uint32_t value, size;
+                if (!read(data, base, &name) || !read(data, base + 4, &value) || !read(data, base + 8, &size))
+                    return false;
+                symbol = {value, size};
+            }
+
+            std::string_view symbolName = readCString(strings, name);
+            symbolNames.push_back(symbolName);
+            symbols.emplace(symbolName, symbol);
+        }
+        break;
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+bool PluginImage::parsePE()
+{
+    format = Format::PE;
+
+    std::uint32_t peOffset;
+    if (!read(data, 0x3C, &peOffset) || peOffset > data.size() ||
+        data.substr(peOffset, 4) != std::string_view("PE\0\0", 4))
+        return false;
+
+    const std::uint64_t coff = std::uint64_t(peOffset) + 4;
+    std::uint16_t sectionCount, optionalHeaderSize, magic;
+    if (!read(data, coff + 2, &sectionCount) || !read(data, coff + 16, &optionalHeaderSize))
+        return false;
+
+    const std::uint64_t optionalHeader = coff + 20;
+    std::uint64_t directories;
+    std::uint32_t directoryCount;
+    if (!read(data, optionalHeader, &magic))
+        return false;
+    if (magic == 0x10b /* PE32 */)
+    {
+        std::uint32_t imageBase32;
+        if (!read(data, optionalHeader + 28, &imageBase32) || !read(data, optionalHeader + 92, &directoryCount))
+            return false;
+        imageBase = imageBase32;
+        pointerSize = 4;
+        directories = optionalHeader + 96;
+    }
+    else if (magic == 0x20b /* PE32+ */)
+    {
+        if (!read(data, optionalHeader + 24, &imageBase) || !read(data, optionalHeader + 108, &directoryCount))
+            return false;
+        pointerSize = 8;
+        directories = optionalHeader + 112;
+    }
+    else
+        return false;
+
+    // Section addresses are relative to the image base
+    const std::uint64_t sectionTable = optionalHeader + optionalHeaderSize;
+    for (std::uint16_t i = 0; i != sectionCount; ++i)
+    {
+        std::uint64_t base = sectionTable + i * 40u;
+        std::uint32_t virtualSize, virtualAddress, rawSize, rawOffset;
+        if (!read(data, base + 8, &virtualSize) || !read(data, base + 12, &virtualAddress) ||
+            !read(data, base + 16, &rawSize) || !read(data, base + 20, &rawOffset))
+            return false;
+        sections.push_back({virtualAddress, rawOffset, virtualSize ? std::min(virtualSize, rawSize) : rawSize});
+    }
+
+    std::uint32_t exportDirectory = 0;
+    if (directoryCount > 0)
+        read(data, directories + 0, &exportDirectory);
+    if (directoryCount > 2)
+        read(data, directories + 2 * 8, &resourceDirectory);
+
+    // Exports take the place of the dynamic symbol table. They don't have a
+    // size, but all symbols we look up are pointers.
+    if (exportDirectory)
+    {
+        auto exports = contentAt(exportDirectory);
+        std::uint32_t functionCount, nameCount, functions, names, ordinals;
+        if (!exports || !read(*exports, 20, &functionCount) || !read(*exports, 24, &nameCount) ||
+            !read(*exports, 28, &functions) || !read(*exports, 32, &names) || !read(*exports, 36, &ordinals))
+            return false;
+
+        auto functionTable = contentAt(functions);
+        auto nameTable = contentAt(names);
+        auto ordinalTable = contentAt(ordinals);
+        if (!functionTable || !nameTable || !ordinalTable)
+            return false;
+
+        symbolNames.reserve(nameCount);
+        symbols.reserve(nameCount);
+        for (std::uint32_t i = 0; i != nameCount; ++i)
+        {
+            std::uint32_t nameAddress, functionAddress;
+            std::uint16_t ordinal;
+            if (!read(*nameTable, i * 4u, &nameAddress) || !read(*ordinalTable, i * 2u, &ordinal) ||
+                ordinal >= functionCount || !read(*functionTable, ordinal * 4u, &functionAddress))
+                return false;
+
+            auto name = contentAt(nameAddress);
+            if (!name)
+                return false;
+            std::string_view symbolName = name->substr(0, name->find('\0'));
+            symbolNames.push_back(symbolName);
+            symbols.emplace(symbolName, Symbol{functionAddress, pointerSize});
+        }
+    }
+
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+std::optional<std::string_view> PluginImage::contentAt(std::uint64_t address) const
+{
+    for (const auto& section : sections)
+    {
+        if (address < section.virtualAddress || address - section.virtualAddress >= section.fileSize)
+            continue;
+
+        std::uint64_t offset = section.fileOffset + (address - section.virtualAddress);
+        if (offset >= data.size())
+            return std::nullopt;
+        std::uint64_t end = std::min<std::uint64_t>(section.fileOffset + section.fileSize, data.size());
+        return data.substr(offset, end - offset);
+    }
+
+    return std::nullopt;
+}
+
+// ----------------------------------------------------------------------------
+PluginInfo::~PluginInfo() = default;
+
+// ----------------------------------------------------------------------------
+Reference<PluginInfo> PluginInfo::open(const std::string& path)
+{
+    Reference<PluginInfo> info = new PluginInfo(path);
+    if (info->image() == nullptr)
         return nullptr;
+    return info;
+}
+
+// ----------------------------------------------------------------------------
+Reference<PluginInfo> PluginInfo::openDeferred(const std::string& path)
+{
+    return new PluginInfo(path);
+}
+
+// ----------------------------------------------------------------------------
+void PluginInfo::releaseImage()
+{
+    std::lock_guard<std::mutex> lock(imageMutex_);
+    image_.reset();
+}
+
+// ----------------------------------------------------------------------------
+PluginImage* PluginInfo::image() const
+{
+    // Plugins are shared between compilations, so the image may be requested
+    // by several threads at once
+    std::lock_guard<std::mutex> lock(imageMutex_);
+    if (image_ == nullptr)
+    {
+        auto image = std::make_unique<PluginImage>();
+        image->file = MappedFile::open(path_.c_str());
+        if (image->file == nullptr)
+        {
+            Log::codegen(Log::ERROR, "Failed to open plugin %s\n", path_.c_str());
+            return nullptr;
+        }
+
+        image->data = std::string_view(image->file->data(), image->file->size());
+        if (!image->parse())
+        {
+            Log::codegen(Log::ERROR, "Failed to open plugin %s: Not a valid ELF or PE file\n", path_.c_str());
+            return nullptr;
+        }
+
+        image_ = std::move(image);
     }
+    return image_.get();
 }
 
+// ----------------------------------------------------------------------------
 const char *PluginInfo::getPath() const {
     return path_.c_str();
 }
 
+// ----------------------------------------------------------------------------
 const char* PluginInfo::getName() const
 {
     return name_.c_str();
 }
 
+// ----------------------------------------------------------------------------
 size_t PluginInfo::getSymbolCount() const
 {
-    const auto* elfBinary = dynamic_cast<const LIEF::ELF::Binary*>(binary_.get());
-    return elfBinary ? elfBinary->dynamic_symbols().size() : binary_->symbols().size();
+    const PluginImage* image = this->image();
+    return image ? image->symbolNames.size() : 0;
 }
 
+// ----------------------------------------------------------------------------
 std::string PluginInfo::getSymbolNameAt(size_t idx) const
 {
-    const auto* elfBinary = dynamic_cast<const LIEF::ELF::Binary*>(binary_.get());
-    return elfBinary ? elfBinary->dynamic_symbols()[idx].name() : binary_->symbols()[idx].name();
+    return std::string(image()->symbolNames[idx]);
 }
 
-std::optional<std::string> PluginInfo::lookupStringBySymbol(const std::string& name)
+// ----------------------------------------------------------------------------
+std::optional<std::string_view> PluginInfo::lookupStringBySymbol(std::string_view name) const
 {
-    if (!binary_->has_symbol(name)) {
+    const PluginImage* image = this->image();
+    if (image == nullptr) {
         return std::nullopt;
     }
 
-    const auto& symbol = binary_->get_symbol(name);
+    auto symbol = image->symbols.find(name);
+    if (symbol == image->symbols.end()) {
+        return std::nullopt;
+    }
 
     // The symbol stores a virtual address to the actual string data, look that up.
-    auto buffer = binary_->get_content_from_virtual_address(symbol.value(), symbol.size());
+    auto pointer = image->contentAt(symbol->second.value);
+    if (!pointer || symbol->second.size > sizeof(std::uint64_t) || pointer->size() < symbol->second.size) {
+        return std::nullopt;
+    }
     std::uint64_t address = 0;
-    std::memcpy(&address, buffer.data(), buffer.size());
-
-    // Look up the string itself. We need to read the string in a buffered loop until we hit a null terminator.
-    std::string result;
-    bool foundNullTerminator = false;
-    while (!foundNullTerminator)
-    {
-        // Load bytes from the virtual address.
-        const std::uint64_t bufferSize = 64;
-        auto bytes = binary_->get_content_from_virtual_address(address, bufferSize);
-        address += bufferSize;
-
-        // Have we encountered a null terminator yet?
-        int size = 1;
-        for (; size <= int(bytes.size()); ++size) {
-            if (bytes[size] == '\0') {
-                foundNullTerminator = true;
-                break;
-            }
-        }
-
-        // Copy 'size' bytes into the string.
-        result.append(reinterpret_cast<const char*>(bytes.data()), size);
-
-        // If 'get_content_from_virtual_address' truncated the result (because we ran out of bytes to read), then stop.
-        if (bytes.size() < bufferSize) {
-            break;
-        }
+    std::memcpy(&address, pointer->data(), symbol->second.size);
+    if (image->format == PluginImage::Format::PE && address >= image->imageBase) {
+        address -= image->imageBase;
     }
 
-    return {result};
+    // If there's no null terminator before the end of the section, the string is truncated.
+    auto string = image->contentAt(address);
+    if (!string) {
+        return std::nullopt;
+    }
+    return string->substr(0, string->find('\0'));
 }
 
+// ----------------------------------------------------------------------------
 std::vector<std::string> PluginInfo::getStringTable() const
 {
-    const auto* binary = binary_.get();
-    if (binary->format() != LIEF::FORMAT_PE) {
+    const PluginImage* image = this->image();
+    if (image == nullptr || image->format != PluginImage::Format::PE || image->resourceDirectory == 0) {
         // Other executable formats don't support string tables.
         return {};
     }
 
-    const auto* peBinary = static_cast<const LIEF::PE::Binary*>(binary);
+    auto resources = image->contentAt(image->resourceDirectory);
+    if (!resources) {
+        return {};
+    }
+
+    // Calls f(id, offset) for every entry of the resource directory at the given offset. Offsets are relative to
+    // the start of the resource section and have the high bit set if they point to another directory.
+    auto forEachEntry = [&resources](std::uint32_t directory, auto&& f) {
+        std::uint16_t namedCount, idCount;
+        if (!read(*resources, directory + 12, &namedCount) || !read(*resources, directory + 14, &idCount)) {
+            return;
+        }
+        for (std::uint32_t i = 0; i != std::uint32_t(namedCount) + idCount; ++i) {
+            std::uint32_t id, offset;
+            if (!read(*resources, directory + 16 + i * 8, &id) || !read(*resources, directory + 20 + i * 8, &offset)) {
+                return;
+            }
+            f(id, offset);
+        }
+    };
 
+    const std::uint32_t subdirectory = 0x80000000;
+    const std::uint32_t stringTableType = 6;  // RT_STRING
+
+    // Directories are nested by type, then by block of 16 strings, then by language
     std::vector<std::string> stringTable;
-    if (peBinary->resources_manager().has_string_table()) {
-        std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> conv;
-        auto peStringTable = peBinary->resources_manager().string_table();
-        stringTable.reserve(peStringTable.size());
-        for (const auto& entry : peStringTable)
-        {
-            stringTable.push_back(conv.to_bytes(entry.name()));
+    forEachEntry(0, [&](std::uint32_t type, std::uint32_t typeOffset) {
+        if (type != stringTableType || !(typeOffset & subdirectory)) {
+            return;
         }
-    }
+        forEachEntry(typeOffset & ~subdirectory, [&](std::uint32_t, std::uint32_t blockOffset) {
+            if (!(blockOffset & subdirectory)) {
+                return;
+            }
+            forEachEntry(blockOffset & ~subdirectory, [&](std::uint32_t, std::uint32_t dataEntry) {
+                std::uint32_t dataAddress, dataSize;
+                if ((dataEntry & subdirectory) || !read(*resources, dataEntry, &dataAddress) ||
+                    !read(*resources, dataEntry + 4, &dataSize)) {
+                    return;
+                }
+                auto block = image->contentAt(dataAddress);
+                if (!block) {
+                    return;
+                }
+                std::string_view strings = block->substr(0, dataSize);
+
+                // Each string is stored as a 16-bit length followed by that many UTF-16 characters
+                for (std::uint64_t pos = 0; pos + 2 <= strings.size();) {
+                    std::uint16_t length;
+                    read(strings, pos, &length);
+                    pos += 2;
+                    if (pos + length * 2u > strings.size()) {
+                        break;
+                    }
+                    if (length > 0) {
+                        stringTable.push_back(utf16ToUTF8(strings, pos, length));
+                    }
+                    pos += length * 2u;
+                }
+            });
+        });
+    });
+
     return stringTable;
 }
 
-PluginInfo::PluginInfo(std::unique_ptr<LIEF::Binary> binary, const std::string& path)
-    : binary_(std::move(binary)),
+// ----------------------------------------------------------------------------
+PluginInfo::PluginInfo(const std::string& path)
+    : RefCounted(RefCountPolicy::ThreadSafe),
       path_(path),
       name_(std::filesystem::path{path}.stem().string())
 {
 }
-} // namespace odb
\ No newline at end of file
+} // namespace odb
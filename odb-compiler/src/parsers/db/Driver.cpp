@@ -1,4 +1,5 @@
 #include "odb-compiler/ast/Annotation.hpp"
+#include "odb-compiler/ast/Arena.hpp"
 #include "odb-compiler/ast/ArrayRef.hpp"
 #include "odb-compiler/ast/Assignment.hpp"
 #include "odb-compiler/ast/BinaryOp.hpp"
@@ -14,13 +15,15 @@
 #include "odb-compiler/parsers/db/KeywordToken.hpp"
 #include "odb-compiler/commands/CommandMatcher.hpp"
 #include "odb-sdk/Log.hpp"
-#include "odb-sdk/Str.hpp"
 #include "odb-sdk/FileSystem.hpp"
+#include "odb-sdk/MappedFile.hpp"
+#include "odb-sdk/TimeReport.hpp"
 
 #include <cassert>
 #include <cstring>
 #include <algorithm>
 #include <memory>
+#include <string_view>
 
 #if defined(ODBCOMPILER_VERBOSE_BISON)
 extern int dbdebug;
@@ -29,45 +32,132 @@ extern int dbdebug;
 namespace odb {
 namespace db {
 
+namespace {
+
+struct Token
+{
+    int pushedChar;
+    DBSTYPE pushedValue;
+    DBLTYPE loc;
+    std::string_view str;
+};
+
 // ----------------------------------------------------------------------------
-static bool tokenHasFreeableString(int pushedChar)
+/*!
+ * FIFO of tokens that were scanned but not pushed to the parser yet. The
+ * storage is a power-of-two sized ring that only grows when a command
+ * look-ahead needs more tokens than ever before, so pushing and popping
+ * tokens doesn't allocate.
+ */
+class TokenQueue
 {
-    switch (pushedChar)
+public:
+    explicit TokenQueue(int minCapacity)
     {
-        case TOK_STRING_LITERAL:
-        case TOK_SYMBOL:
-        case TOK_COMMAND:
-            return true;
+        int capacity = 8;
+        while (capacity < minCapacity)
+            capacity *= 2;
+        tokens_.resize(capacity);
+    }
+
+    int size() const { return size_; }
+    Token& operator[](int i) { return tokens_[(head_ + i) & (tokens_.size() - 1)]; }
+    Token& back() { return (*this)[size_ - 1]; }
 
-        default:
-            return false;
+    void push_back(const Token& token)
+    {
+        if (size_ == (int)tokens_.size())
+            grow();
+        (*this)[size_++] = token;
+    }
+
+    void pop_front(int count=1)
+    {
+        assert(count <= size_);
+        head_ = (head_ + count) & (tokens_.size() - 1);
+        size_ -= count;
     }
+
+private:
+    void grow()
+    {
+        std::vector<Token> tokens(tokens_.size() * 2);
+        for (int i = 0; i != size_; ++i)
+            tokens[i] = (*this)[i];
+        tokens_.swap(tokens);
+        head_ = 0;
+    }
+
+    std::vector<Token> tokens_;
+    int head_ = 0;
+    int size_ = 0;
+};
+
 }
 
 // ----------------------------------------------------------------------------
-ast::Block* Driver::doParse(dbscan_t scanner, dbpstate* parser, const cmd::CommandMatcher& commandMatcher)
+char* TokenStringArena::newString(const char* str, std::size_t len)
 {
-    int parseResult;
-    DBLTYPE loc = {1, 1, 1, 1};
+    static const std::size_t chunkSize = 64 * 1024;
 
-    struct Token
+    char* result;
+    if (len + 1 > chunkSize)
     {
-        int pushedChar;
-        DBSTYPE pushedValue;
-        DBLTYPE loc;
-        std::string str;
-    };
-
-    struct MergedTokenOffset
+        oversized_.emplace_back(new char[len + 1]);
+        result = oversized_.back().get();
+    }
+    else
     {
-        int lookAheadEnd;
-        int cmdlen;
-    };
+        if (chunks_.empty() || used_ + len + 1 > chunkSize)
+        {
+            if (!chunks_.empty())
+                chunk_++;
+            if (chunk_ == chunks_.size())
+                chunks_.emplace_back(new char[chunkSize]);
+            used_ = 0;
+        }
+
+        result = chunks_[chunk_].get() + used_;
+        used_ += len + 1;
+    }
+
+    std::memcpy(result, str, len);
+    result[len] = '\0';
+    return result;
+}
+
+// ----------------------------------------------------------------------------
+void TokenStringArena::reset()
+{
+    oversized_.clear();
+    chunk_ = 0;
+    used_ = 0;
+}
+
+// ----------------------------------------------------------------------------
+char* Driver::newTokenString(const char* str, std::size_t len)
+{
+    return tokenStrings_.newString(str, len);
+}
+
+// ----------------------------------------------------------------------------
+ast::Block* Driver::doParse(dbscan_t scanner, dbpstate* parser, const cmd::CommandMatcher& commandMatcher)
+{
+    int parseResult;
+    DBLTYPE loc(0, 0);
 
 #if defined(ODBCOMPILER_VERBOSE_BISON)
     dbdebug = 1;
 #endif
 
+    // Strings from a previous parse are no longer referenced by anything
+    tokenStrings_.reset();
+
+    // All nodes and locations created during this parse are allocated from
+    // one arena. It is freed in one go once the returned tree (and anything
+    // else still referencing parts of it) has been released.
+    ast::ArenaScope arenaScope;
+
     // This is used as a buffer to assemble a command out of multiple tokens
     // and check it against the command matcher.
     std::string possibleCommand;
@@ -75,14 +165,18 @@ ast::Block* Driver::doParse(dbscan_t scanner, dbpstate* parser, const cmd::Comma
 
     // This is used to store all tokens that haven't been push parsed yet, which
     // will be more than 1 when doing a command match.
-    std::vector<Token> tokens;
-    tokens.reserve(commandMatcher.longestCommandWordCount());
+    TokenQueue tokens(commandMatcher.longestCommandWordCount() * 2 + 2);
 
-    // Scans the next token and stores it in "tokens"
+    // Scans the next token and stores it in "tokens". Both drivers scan a
+    // single in-memory buffer that FLEX never refills or moves, so the text
+    // of a token can be referenced in place for as long as the parse runs.
+    // FLEX only writes a terminator after the most recent token, which is
+    // why the length is stored too.
     auto scanNextToken = [&](){
         DBSTYPE pushedValue;
         int pushedChar = dblex(&pushedValue, &loc, scanner);
-        tokens.push_back({pushedChar, pushedValue, loc, ""});
+        tokens.push_back({pushedChar, pushedValue, loc,
+                          std::string_view(dbget_text(scanner), dbget_leng(scanner))});
     };
 
     // Scans ahead to get as many TOK_SYMBOL type tokens
@@ -96,36 +190,27 @@ ast::Block* Driver::doParse(dbscan_t scanner, dbpstate* parser, const cmd::Comma
             int tokenIdx;
         } result = {};
 
-        // The main parser loop deliberately doesn't set the string to save on
-        // memory allocations because it never stores more than one token, which
-        // means the string is always accessible through dbget_text(). Now that
-        // we have to store more than one token, it's necessary to store the
-        // string too.
-        if (tokens.back().str.empty())
-            tokens.back().str = dbget_text(scanner);
-
-        possibleCommand = tokens[0].str;
+        // The matcher is fed only the characters that were appended to
+        // possibleCommand since the last iteration, so matching is linear in
+        // the length of the command. Scanning stops as soon as the assembled
+        // string can no longer be the start of any command.
+        cmd::CommandMatcher::MatchState match = commandMatcher.beginMatch();
+        possibleCommand.assign(tokens[0].str);
         bool lastSymbolWasInteger = false;
-        for (int i = 1; (int)possibleCommand.length() <= commandMatcher.longestCommandLength(); ++i)
+        for (int i = 1; commandMatcher.continueMatch(match,
+                                                     possibleCommand.c_str() + match.matchedLength,
+                                                     (int)possibleCommand.length() - match.matchedLength); ++i)
         {
 #if defined(ODBCOMPILER_VERBOSE_FLEX)
-            fprintf(stderr, "findLongestCommandMatching(\"%s\")\n", possibleCommand.c_str());
-#endif
-            auto match = commandMatcher.findLongestCommandMatching(possibleCommand);
-            if (match.found && match.matchedLength == (int)possibleCommand.size())
-                result = {match, i};
-
-#if defined(ODBCOMPILER_VERBOSE_FLEX)
-            fprintf(stderr, "found==%d, matchedLength: %d\n", match.found, match.matchedLength);
+            fprintf(stderr, "continueMatch(\"%s\"): found==%d\n", possibleCommand.c_str(), match.found);
 #endif
+            if (match.found)
+                result = {{match.matchedLength, true}, i};
 
             // Maybe need to scan for the next token, or maybe there's enough
             // in the queue.
-            if (i == (int)tokens.size())
-            {
+            if (i == tokens.size())
                 scanNextToken();
-                tokens.back().str = dbget_text(scanner);
-            }
 
             // EOF or error
             if (tokens[i].pushedChar == TOK_END || tokens[i].pushedChar == TOK_DBEMPTY)
@@ -137,31 +222,29 @@ ast::Block* Driver::doParse(dbscan_t scanner, dbpstate* parser, const cmd::Comma
             // can end in type annotation characters such as $ or #, in which
             // case we also do not want to append a space.
             if (!lastSymbolWasInteger && !ast::isAnnotation(tokens[i].pushedChar))
-                possibleCommand += " ";
+                possibleCommand += ' ';
             else if (result.tokenIdx == i && ast::isAnnotation(tokens[i].pushedChar))
                 result.match.found = false;
-            possibleCommand += tokens[i].str;
+            possibleCommand.append(tokens[i].str);
             lastSymbolWasInteger = (tokens[i].pushedChar == TOK_INTEGER_LITERAL);
         }
 
         if (result.match.found)
         {
-            // All tokens we scanned leading up to the last one can
-            // be discarded, because they can all be merged into
-            // a single command now.
-            for (int i = 0; i != result.tokenIdx; ++i)
-                if (tokenHasFreeableString(tokens[i].pushedChar))
-                    str::deleteCStr(tokens[i].pushedValue.string);
-            tokens.erase(tokens.begin() + 1, tokens.begin() + result.tokenIdx);
-
-            // Ownership of the string is passed to BISON
-            tokens[0].pushedValue.string = str::newCStrRange(possibleCommand.c_str(), 0, result.match.matchedLength);
-            tokens[0].pushedChar = TOK_COMMAND;
+            // All tokens we scanned leading up to the last one can be
+            // discarded, because they can all be merged into a single command
+            // now. The first token takes the place of the last discarded one.
+            Token& merged = tokens[result.tokenIdx - 1];
+            merged = tokens[0];
+            tokens.pop_front(result.tokenIdx - 1);
+
+            merged.pushedValue.string = newTokenString(possibleCommand.c_str(), result.match.matchedLength);
+            merged.pushedChar = TOK_COMMAND;
 #if defined(ODBCOMPILER_VERBOSE_FLEX)
-            fprintf(stderr, "Merged into command: \"%s\"\n", tokens[0].pushedValue.string);
+            fprintf(stderr, "Merged into command: \"%s\"\n", merged.pushedValue.string);
             fprintf(stderr, "Tokens in queue:");
-            for (const auto& token : tokens)
-                fprintf(stderr, " %d", token.pushedChar);
+            for (int i = 0; i != tokens.size(); ++i)
+                fprintf(stderr, " %d", tokens[i].pushedChar);
             fprintf(stderr, "\n");
 #endif
         }
@@ -230,11 +313,7 @@ ast::Block* Driver::doParse(dbscan_t scanner, dbpstate* parser, const cmd::Comma
 
                 const KeywordToken::Result* result = KeywordToken::lookup(tokens[0].pushedValue.string);
                 if (result)
-                {
-                    // Change token type and don't forget to free the symbol string
                     tokens[0].pushedChar = result->token;
-                    str::deleteCStr(tokens[0].pushedValue.string);
-                }
             } break;
 
             // Allow commands to be changed to builtin commands. This is something
@@ -259,23 +338,16 @@ ast::Block* Driver::doParse(dbscan_t scanner, dbpstate* parser, const cmd::Comma
                 location->printUnderlinedSection(Log::info);
                 Log::dbParserNotice("This is normal behavior for DBP plugins, but should not be ignored if using the ODB SDK.\n");
 
-                // Change token type and don't forget to free the symbol string
                 tokens[0].pushedChar = result->token;
-                str::deleteCStr(tokens[0].pushedValue.string);
             } break;
 
             default: break;
         }
 
         parseResult = dbpush_parse(parser, tokens[0].pushedChar, &tokens[0].pushedValue, &tokens[0].loc, scanner);
-        tokens.erase(tokens.begin());
+        tokens.pop_front();
     } while (parseResult == YYPUSH_MORE);
 
-    // May need to clean up
-    for (auto& token : tokens)
-        if (tokenHasFreeableString(token.pushedChar))
-            str::deleteCStr(token.pushedValue.string);
-
     if (parseResult == 0)
     {
         ast::Block* program = program_;
@@ -286,6 +358,20 @@ ast::Block* Driver::doParse(dbscan_t scanner, dbpstate* parser, const cmd::Comma
     return nullptr;
 }
 
+// ----------------------------------------------------------------------------
+int Driver::doScan(dbscan_t scanner)
+{
+    tokenStrings_.reset();
+
+    int tokenCount = 0;
+    DBSTYPE value;
+    DBLTYPE loc(0, 0);
+    while (dblex(&value, &loc, scanner) != TOK_END)
+        tokenCount++;
+
+    return tokenCount;
+}
+
 // ----------------------------------------------------------------------------
 void Driver::giveProgram(ast::Block* program)
 {
@@ -393,28 +479,41 @@ ast::Assignment* Driver::newIncDecUDTField(ast::UDTFieldOuter* value, IncDecDir
 ast::Block* FileParserDriver::parse(const std::string& fileName,
                                     const cmd::CommandMatcher& commandMatcher)
 {
-    FILE* fp = fopen(fileName.c_str(), "r");
-    if (fp == nullptr)
+    ScopedTimer timer("parse", fileName);
+
+    // The lexer scans the file in place instead of copying it through its
+    // own input buffer. FLEX writes NUL terminators into the buffer while
+    // scanning and expects two NUL bytes at the end, so it gets a private,
+    // zero padded mapping. Since it writes behind every token, every page
+    // ends up copied, so this costs as much memory as reading the file into
+    // a buffer, but saves the copy up front. The buffer isn't intact during
+    // the parse, so the line index locations are resolved with is built from
+    // it before scanning starts. Diagnostics that print the code itself make
+    // the file source map the file a second time.
+    Reference<MappedFile> input = MappedFile::openPrivate(fileName.c_str(), 2);
+    if (input.isNull())
     {
         Log::dbParserFailedToOpenFile(fileName.c_str());
         return nullptr;
     }
 
-    // Create new parser and lexer instances and initialize lexer to point at
-    // file
+    source_ = new ast::FileSourceBuffer(fileName);
+    source_->indexLines(std::string_view(input->data(), input->size()));
+
+    // Create new parser and lexer instances and initialize buffer to point at
+    // the mapped file
     dbscan_t scanner;
     dbpstate* parser = dbpstate_new();
     dblex_init_extra(this, &scanner);
-    dbset_in(fp, scanner);
+    YY_BUFFER_STATE buf = db_scan_buffer(input->writableData(), input->size() + 2, scanner);
 
-    fileName_ = &fileName;
     ast::Block* program = doParse(scanner, parser, commandMatcher);
-    fileName_ = nullptr;
+    source_.reset();
 
     // Destroy parser and lexer
+    db_delete_buffer(buf, scanner);
     dbpstate_delete(parser);
     dblex_destroy(scanner);
-    fclose(fp);
 
     return program;
 }
@@ -424,6 +523,8 @@ ast::Block* StringParserDriver::parse(const std::string& sourceName,
                                       const std::string& str,
                                       const cmd::CommandMatcher& commandMatcher)
 {
+    ScopedTimer timer("parse", sourceName);
+
     // Create new parser and lexer instances and initialize buffer to point at
     // input string
     dbscan_t scanner;
@@ -431,11 +532,9 @@ ast::Block* StringParserDriver::parse(const std::string& sourceName,
     dblex_init_extra(this, &scanner);
     YY_BUFFER_STATE buf = db_scan_bytes(str.data(), (int)str.length(), scanner);
 
-    code_ = &str;
-    sourceName_ = &sourceName;
+    source_ = new ast::InlineSourceBuffer(sourceName, str);
     ast::Block* program = doParse(scanner, parser, commandMatcher);
-    sourceName_ = nullptr;
-    code_ = nullptr;
+    source_.reset();
 
     db_delete_buffer(buf, scanner);
     dbpstate_delete(parser);
@@ -445,18 +544,28 @@ ast::Block* StringParserDriver::parse(const std::string& sourceName,
 }
 
 // ----------------------------------------------------------------------------
-ast::SourceLocation* FileParserDriver::newLocation(const DBLTYPE* loc) const
+int StringParserDriver::scan(const std::string& str)
 {
-    assert(fileName_);
-    return new ast::FileSourceLocation(*fileName_, loc->first_line, loc->last_line, loc->first_column, loc->last_column);
+    dbscan_t scanner;
+    dblex_init_extra(this, &scanner);
+    YY_BUFFER_STATE buf = db_scan_bytes(str.data(), (int)str.length(), scanner);
+
+    int tokenCount = doScan(scanner);
+
+    db_delete_buffer(buf, scanner);
+    dblex_destroy(scanner);
+
+    return tokenCount;
 }
 
 // ----------------------------------------------------------------------------
-ast::SourceLocation* StringParserDriver::newLocation(const DBLTYPE* loc) const
+ast::SourceLocation* Driver::newLocation(const DBLTYPE* loc) const
 {
-    assert(sourceName_);
-    assert(code_);
-    return new ast::InlineSourceLocation(*sourceName_, *code_, loc->first_line, loc->last_line, loc->first_column, loc->last_column);
+    assert(source_.notNull());
+
+    // The scanner only tracks byte offsets. They are converted to lines and
+    // columns when the location is first accessed, since most never are
+    return new ast::SourceLocation(source_, loc->first_offset, loc->last_offset);
 }
 
 }
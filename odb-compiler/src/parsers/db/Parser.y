@@ -37,7 +37,6 @@
     #include "odb-compiler/parsers/db/Scanner.hpp"
     #include "odb-compiler/parsers/db/Driver.hpp"
     #include "odb-compiler/commands/Command.hpp"
-    #include "odb-sdk/Str.hpp"
     #include <cstdarg>
 
     #define driver (static_cast<odb::db::Driver*>(dbget_extra(scanner)))
@@ -107,6 +106,36 @@
             class WhileLoop;
         }
     }
+
+    /*
+     * Locations only store byte offsets into the source. The scanner can
+     * update them in constant time per token, and line/column information is
+     * only computed when the driver creates a SourceLocation.
+     */
+    typedef struct DBLTYPE
+    {
+        DBLTYPE() = default;
+        DBLTYPE(int firstOffset, int lastOffset) : first_offset(firstOffset), last_offset(lastOffset) {}
+        /* BISON initializes its default location with { 1, 1, 1, 1 } */
+        DBLTYPE(int, int, int, int) : first_offset(0), last_offset(0) {}
+
+        int first_offset;
+        int last_offset;
+    } DBLTYPE;
+    #define DBLTYPE_IS_DECLARED 1
+    #define DBLTYPE_IS_TRIVIAL 1
+
+    #define YYLLOC_DEFAULT(Current, Rhs, N) do {                              \
+            if (N) {                                                          \
+                (Current).first_offset = YYRHSLOC(Rhs, 1).first_offset;       \
+                (Current).last_offset = YYRHSLOC(Rhs, N).last_offset;         \
+            } else {                                                          \
+                (Current).first_offset = (Current).last_offset =              \
+                    YYRHSLOC(Rhs, 0).last_offset;                             \
+            }                                                                 \
+        } while (0)
+    #define YY_LOCATION_PRINT(File, Loc)                                      \
+        fprintf(File, "%d-%d", (Loc).first_offset, (Loc).last_offset)
 }
 
 /*
@@ -153,7 +182,7 @@
     int64_t integer_value;
     float float_value;
     double double_value;
-    char* string;
+    char* string;  /* Owned by the driver, see Driver::newTokenString() */
     char scope;
 
     odb::ast::AnnotatedSymbol* annotated_symbol;
@@ -199,7 +228,6 @@
     odb::ast::WhileLoop* while_loop;
 }
 
-%destructor { str::deleteCStr($$); } <string>
 %destructor { TouchRef($$); } <symbol>
 %destructor { TouchRef($$); } <annotated_symbol>
 %destructor { TouchRef($$); } <array_decl>
@@ -517,17 +545,17 @@ expr
 /* Commands appearing as statements usually don't have arguments surrounded by
  * brackets, but it is valid to call a command with brackets as a statement */
 command_stmnt
-  : COMMAND                                                   { $$ = new CommandStmnt($1, driver->newLocation(&@$)); str::deleteCStr($1); }
-  | COMMAND arg_list                                         { $$ = new CommandStmnt($1, $2, driver->newLocation(&@$)); str::deleteCStr($1); }
-  | COMMAND '(' ')'                                           { $$ = new CommandStmnt($1, driver->newLocation(&@$)); str::deleteCStr($1); }
+  : COMMAND                                                   { $$ = new CommandStmnt($1, driver->newLocation(&@$)); }
+  | COMMAND arg_list                                         { $$ = new CommandStmnt($1, $2, driver->newLocation(&@$)); }
+  | COMMAND '(' ')'                                           { $$ = new CommandStmnt($1, driver->newLocation(&@$)); }
 /* This case is already handled by expr
-  | COMMAND '(' arg_list ')'                                 { $$ = new CommandStmnt($1, $3, driver->newLocation(&@$)); str::deleteCStr($1); } */
+  | COMMAND '(' arg_list ')'                                 { $$ = new CommandStmnt($1, $3, driver->newLocation(&@$)); } */
   ;
 
 /* Commands appearing in expressions must be called with arguments in brackets */
 command_expr
-  : COMMAND '(' ')'                                           { $$ = new CommandExpr($1, driver->newLocation(&@$)); str::deleteCStr($1); }
-  | COMMAND '(' arg_list ')'                                 { $$ = new CommandExpr($1, $3, driver->newLocation(&@$)); str::deleteCStr($1); }
+  : COMMAND '(' ')'                                           { $$ = new CommandExpr($1, driver->newLocation(&@$)); }
+  | COMMAND '(' arg_list ')'                                 { $$ = new CommandExpr($1, $3, driver->newLocation(&@$)); }
   ;
 const_decl
   : CONSTANT annotated_symbol expr                            { $$ = new ConstDeclExpr($2, $3, driver->newLocation(&@$)); }
@@ -653,12 +681,12 @@ scope
   : GLOBAL                                                    { $$ = static_cast<char>(Scope::GLOBAL); }
   | LOCAL                                                     { $$ = static_cast<char>(Scope::LOCAL); }
   ;
-var_int_sym          : SYMBOL %prec NO_ANNOTATION             { $$ = new ScopedAnnotatedSymbol(Scope::LOCAL, Annotation::NONE, $1, driver->newLocation(&@$)); str::deleteCStr($1); };
-var_double_int_sym   : SYMBOL '&'                             { $$ = new ScopedAnnotatedSymbol(Scope::LOCAL, Annotation::DOUBLE_INTEGER, $1, driver->newLocation(&@$)); str::deleteCStr($1); };
-var_word_sym         : SYMBOL '%'                             { $$ = new ScopedAnnotatedSymbol(Scope::LOCAL, Annotation::WORD, $1, driver->newLocation(&@$)); str::deleteCStr($1); };
-var_double_float_sym : SYMBOL '!'                             { $$ = new ScopedAnnotatedSymbol(Scope::LOCAL, Annotation::DOUBLE_FLOAT, $1, driver->newLocation(&@$)); str::deleteCStr($1); };
-var_float_sym        : SYMBOL '#'                             { $$ = new ScopedAnnotatedSymbol(Scope::LOCAL, Annotation::FLOAT, $1, driver->newLocation(&@$)); str::deleteCStr($1); };
-var_str_sym          : SYMBOL '$'                             { $$ = new ScopedAnnotatedSymbol(Scope::LOCAL, Annotation::STRING, $1, driver->newLocation(&@$)); str::deleteCStr($1); };
+var_int_sym          : SYMBOL %prec NO_ANNOTATION             { $$ = new ScopedAnnotatedSymbol(Scope::LOCAL, Annotation::NONE, $1, driver->newLocation(&@$)); };
+var_double_int_sym   : SYMBOL '&'                             { $$ = new ScopedAnnotatedSymbol(Scope::LOCAL, Annotation::DOUBLE_INTEGER, $1, driver->newLocation(&@$)); };
+var_word_sym         : SYMBOL '%'                             { $$ = new ScopedAnnotatedSymbol(Scope::LOCAL, Annotation::WORD, $1, driver->newLocation(&@$)); };
+var_double_float_sym : SYMBOL '!'                             { $$ = new ScopedAnnotatedSymbol(Scope::LOCAL, Annotation::DOUBLE_FLOAT, $1, driver->newLocation(&@$)); };
+var_float_sym        : SYMBOL '#'                             { $$ = new ScopedAnnotatedSymbol(Scope::LOCAL, Annotation::FLOAT, $1, driver->newLocation(&@$)); };
+var_str_sym          : SYMBOL '$'                             { $$ = new ScopedAnnotatedSymbol(Scope::LOCAL, Annotation::STRING, $1, driver->newLocation(&@$)); };
 
 udt_decl
   : TYPE symbol seps udt_body_decl seps ENDTYPE               { $$ = new UDTDecl($2, $4, driver->newLocation(&@$)); }
@@ -672,7 +700,7 @@ udt_body_decl
   | array_decl_as_type                                        { $$ = new UDTDeclBody($1, driver->newLocation(&@$)); }
   ;
 udt_ref
-  : SYMBOL %prec NO_ANNOTATION                                { $$ = new UDTRef($1, driver->newLocation(&@$)); str::deleteCStr($1); }
+  : SYMBOL %prec NO_ANNOTATION                                { $$ = new UDTRef($1, driver->newLocation(&@$)); }
   ;
 udt_field_lvalue
   : var_ref '.' udt_field_inner                               { $$ = new UDTFieldOuter($1, $3, driver->newLocation(&@$)); }
@@ -729,21 +757,21 @@ literal
   | INTEGER_LITERAL                                           { $$ = driver->newIntLikeLiteral($1, driver->newLocation(&@$)); }
   | DOUBLE_LITERAL                                            { $$ = new DoubleFloatLiteral($1, driver->newLocation(&@$)); }
   | FLOAT_LITERAL                                             { $$ = new FloatLiteral($1, driver->newLocation(&@$)); }
-  | STRING_LITERAL                                            { $$ = new StringLiteral($1, driver->newLocation(&@$)); str::deleteCStr($1); }
+  | STRING_LITERAL                                            { $$ = new StringLiteral($1, driver->newLocation(&@$)); }
   | IMAG_I                                                    { $$ = new ComplexLiteral({0, $1}, driver->newLocation(&@$)); }
   | IMAG_J                                                    { $$ = new QuatLiteral({0, 0, $1, 0}, driver->newLocation(&@$)); }
   | IMAG_K                                                    { $$ = new QuatLiteral({0, 0, 0, $1}, driver->newLocation(&@$)); }
   ;
 annotated_symbol
-  : SYMBOL %prec NO_ANNOTATION                                { $$ = new AnnotatedSymbol(Annotation::NONE, $1, driver->newLocation(&@$)); str::deleteCStr($1); }
-  | SYMBOL '&'                                                { $$ = new AnnotatedSymbol(Annotation::DOUBLE_INTEGER, $1, driver->newLocation(&@$)); str::deleteCStr($1); }
-  | SYMBOL '%'                                                { $$ = new AnnotatedSymbol(Annotation::WORD, $1, driver->newLocation(&@$)); str::deleteCStr($1); }
-  | SYMBOL '!'                                                { $$ = new AnnotatedSymbol(Annotation::DOUBLE_FLOAT, $1, driver->newLocation(&@$)); str::deleteCStr($1); }
-  | SYMBOL '#'                                                { $$ = new AnnotatedSymbol(Annotation::FLOAT, $1, driver->newLocation(&@$)); str::deleteCStr($1); }
-  | SYMBOL '$'                                                { $$ = new AnnotatedSymbol(Annotation::STRING, $1, driver->newLocation(&@$)); str::deleteCStr($1); }
+  : SYMBOL %prec NO_ANNOTATION                                { $$ = new AnnotatedSymbol(Annotation::NONE, $1, driver->newLocation(&@$)); }
+  | SYMBOL '&'                                                { $$ = new AnnotatedSymbol(Annotation::DOUBLE_INTEGER, $1, driver->newLocation(&@$)); }
+  | SYMBOL '%'                                                { $$ = new AnnotatedSymbol(Annotation::WORD, $1, driver->newLocation(&@$)); }
+  | SYMBOL '!'                                                { $$ = new AnnotatedSymbol(Annotation::DOUBLE_FLOAT, $1, driver->newLocation(&@$)); }
+  | SYMBOL '#'                                                { $$ = new AnnotatedSymbol(Annotation::FLOAT, $1, driver->newLocation(&@$)); }
+  | SYMBOL '$'                                                { $$ = new AnnotatedSymbol(Annotation::STRING, $1, driver->newLocation(&@$)); }
   ;
 symbol
-  : SYMBOL                                                    { $$ = new Symbol($1, driver->newLocation(&@$)); str::deleteCStr($1); }
+  : SYMBOL                                                    { $$ = new Symbol($1, driver->newLocation(&@$)); }
   ;
 conditional
   : cond_oneline                                              { $$ = $1; }
@@ -830,8 +858,8 @@ loop_for
   | FOR assignment TO expr seps NEXT                          { $$ = new ForLoop($2, $4, driver->newLocation(&@$)); }
   ;
 loop_next_sym
-  : SYMBOL %prec NO_ANNOTATION                                { $$ = new AnnotatedSymbol(Annotation::NONE, $1, driver->newLocation(&@$)); str::deleteCStr($1); }
-  | SYMBOL '#'                                                { $$ = new AnnotatedSymbol(Annotation::FLOAT, $1, driver->newLocation(&@$)); str::deleteCStr($1); }
+  : SYMBOL %prec NO_ANNOTATION                                { $$ = new AnnotatedSymbol(Annotation::NONE, $1, driver->newLocation(&@$)); }
+  | SYMBOL '#'                                                { $$ = new AnnotatedSymbol(Annotation::FLOAT, $1, driver->newLocation(&@$)); }
   ;
 exit
   : EXIT                                                      { $$ = new Exit(driver->newLocation(&@$)); }
@@ -0,0 +1,153 @@
+#include <gmock/gmock.h>
+#include "odb-compiler/commands/CommandCache.hpp"
+#include "odb-compiler/commands/CommandIndex.hpp"
+#include "odb-compiler/commands/Command.hpp"
+#include "odb-compiler/parsers/PluginInfo.hpp"
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#define NAME cmd_cache
+
+using namespace testing;
+using namespace odb;
+
+namespace fs = std::filesystem;
+
+class NAME : public Test
+{
+public:
+    void SetUp() override
+    {
+        // Every test gets its own directory, so test runs in parallel don't
+        // overwrite each other's files
+        std::random_device random;
+        testDir = fs::temp_directory_path() / ("odb_test_cmd_cache_" + std::to_string(random()) + std::to_string(random()));
+        fs::create_directories(testDir);
+        pluginFile = testDir / "plugin.so";
+        cacheFile = testDir / "cache" / "commands.cache";
+        writePlugin("plugin contents");
+    }
+
+    void TearDown() override
+    {
+        fs::remove_all(testDir);
+    }
+
+    void writePlugin(const char* contents)
+    {
+        std::ofstream(pluginFile, std::ios::binary) << contents;
+    }
+
+    void storeCommands()
+    {
+        cmd::CommandCache cache(cacheFile);
+        std::vector<Reference<cmd::Command>> commands = {
+            new cmd::Command(nullptr, "make object", "MakeObject", cmd::Command::Type::Void,
+                             {{cmd::Command::Type::Integer, "id", "object id"}, {cmd::Command::Type::Float, "size", ""}},
+                             "help/make object.htm"),
+            new cmd::Command(nullptr, "object exist", "ObjectExist", cmd::Command::Type::Dword,
+                             {{cmd::Command::Type::Integer, "id", ""}})
+        };
+        cache.store(pluginFile, commands);
+        ASSERT_THAT(cache.save(), IsTrue());
+    }
+
+    fs::path testDir;
+    fs::path pluginFile;
+    fs::path cacheFile;
+};
+
+TEST_F(NAME, missing_cache_file_is_empty)
+{
+    cmd::CommandCache cache(cacheFile);
+    cmd::CommandIndex index;
+    EXPECT_THAT(cache.load(), IsFalse());
+    EXPECT_THAT(cache.lookup(pluginFile, &index), IsFalse());
+    EXPECT_THAT(index.commands().size(), Eq(0u));
+}
+
+TEST_F(NAME, stored_commands_survive_save_and_load)
+{
+    storeCommands();
+
+    cmd::CommandCache cache(cacheFile);
+    cmd::CommandIndex index;
+    ASSERT_THAT(cache.load(), IsTrue());
+    ASSERT_THAT(cache.lookup(pluginFile, &index), IsTrue());
+    ASSERT_THAT(index.commands().size(), Eq(2u));
+
+    const cmd::Command* makeObject = index.commands()[0];
+    EXPECT_THAT(makeObject->dbSymbol(), StrEq("make object"));
+    EXPECT_THAT(makeObject->cppSymbol(), StrEq("MakeObject"));
+    EXPECT_THAT(makeObject->helpFile(), StrEq("help/make object.htm"));
+    EXPECT_THAT(makeObject->returnType(), Eq(cmd::Command::Type::Void));
+    ASSERT_THAT(makeObject->args().size(), Eq(2u));
+    EXPECT_THAT(makeObject->args()[0].type, Eq(cmd::Command::Type::Integer));
+    EXPECT_THAT(makeObject->args()[0].symName, StrEq("id"));
+    EXPECT_THAT(makeObject->args()[0].description, StrEq("object id"));
+    EXPECT_THAT(makeObject->args()[1].type, Eq(cmd::Command::Type::Float));
+    EXPECT_THAT(makeObject->library()->getPath(), StrEq(pluginFile.string()));
+
+    const cmd::Command* objectExist = index.commands()[1];
+    EXPECT_THAT(objectExist->dbSymbol(), StrEq("object exist"));
+    EXPECT_THAT(objectExist->returnType(), Eq(cmd::Command::Type::Dword));
+}
+
+TEST_F(NAME, changed_plugin_is_not_found)
+{
+    storeCommands();
+    writePlugin("other contents!");
+
+    cmd::CommandCache cache(cacheFile);
+    cmd::CommandIndex index;
+    ASSERT_THAT(cache.load(), IsTrue());
+    EXPECT_THAT(cache.lookup(pluginFile, &index), IsFalse());
+    EXPECT_THAT(index.commands().size(), Eq(0u));
+}
+
+TEST_F(NAME, corrupt_cache_file_is_ignored)
+{
+    storeCommands();
+    fs::resize_file(cacheFile, fs::file_size(cacheFile) - 3);
+
+    cmd::CommandCache cache(cacheFile);
+    cmd::CommandIndex index;
+    EXPECT_THAT(cache.load(), IsFalse());
+    EXPECT_THAT(cache.lookup(pluginFile, &index), IsFalse());
+}
+
+TEST_F(NAME, trailing_data_is_rejected)
+{
+    storeCommands();
+    std::ofstream(cacheFile, std::ios::binary | std::ios::app) << "x";
+
+    cmd::CommandCache cache(cacheFile);
+    cmd::CommandIndex index;
+    EXPECT_THAT(cache.load(), IsFalse());
+    EXPECT_THAT(cache.lookup(pluginFile, &index), IsFalse());
+}
+
+TEST_F(NAME, oversized_command_count_is_rejected)
+{
+    storeCommands();
+
+    // The command count follows the plugin path and its size, mtime and hash
+    std::string data;
+    {
+        std::ifstream file(cacheFile, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    std::string path = pluginFile.string();
+    std::size_t pos = data.find(path);
+    ASSERT_THAT(pos, Ne(std::string::npos));
+    pos += path.size() + 24;
+    ASSERT_THAT(pos + 4, Le(data.size()));
+    data.replace(pos, 4, "\xff\xff\xff\x7f");
+    std::ofstream(cacheFile, std::ios::binary | std::ios::trunc) << data;
+
+    cmd::CommandCache cache(cacheFile);
+    cmd::CommandIndex index;
+    EXPECT_THAT(cache.load(), IsFalse());
+    EXPECT_THAT(cache.lookup(pluginFile, &index), IsFalse());
+}
@@ -0,0 +1,109 @@
+#include <gmock/gmock.h>
+#include "odb-compiler/commands/CommandIndex.hpp"
+#include "odb-compiler/commands/Command.hpp"
+#include <string>
+
+#define NAME cmd_index
+
+using namespace testing;
+using namespace odb;
+
+class NAME : public Test
+{
+public:
+    cmd::Command* addCommand(const std::string& name, std::vector<cmd::Command::Arg> args = {})
+    {
+        cmd::Command* command = new cmd::Command(nullptr, name, name, cmd::Command::Type::Void, args);
+        index.addCommand(command);
+        return command;
+    }
+
+    cmd::CommandIndex index;
+};
+
+TEST_F(NAME, empty_index)
+{
+    EXPECT_THAT(index.lookup("print").empty(), IsTrue());
+}
+
+TEST_F(NAME, lookup_is_case_insensitive)
+{
+    cmd::Command* print = addCommand("print");
+    addCommand("make object");
+    index.freeze();
+
+    auto overloads = index.lookup("PRINT");
+    ASSERT_THAT(overloads.size(), Eq(1u));
+    EXPECT_THAT(overloads.front(), Eq(print));
+}
+
+TEST_F(NAME, lookup_unknown_command)
+{
+    addCommand("print");
+    addCommand("make object");
+    index.freeze();
+
+    EXPECT_THAT(index.lookup("prin").empty(), IsTrue());
+    EXPECT_THAT(index.lookup("print ").empty(), IsTrue());
+    EXPECT_THAT(index.lookup("make objects").empty(), IsTrue());
+}
+
+TEST_F(NAME, overloads_are_grouped_in_insertion_order)
+{
+    cmd::Command* a = addCommand("position object", {{cmd::Command::Type::Integer, "", ""}});
+    addCommand("print");
+    cmd::Command* b = addCommand("Position Object", {{cmd::Command::Type::Float, "", ""}});
+    index.freeze();
+
+    auto overloads = index.lookup("position object");
+    ASSERT_THAT(overloads.size(), Eq(2u));
+    EXPECT_THAT(overloads[0], Eq(a));
+    EXPECT_THAT(overloads[1], Eq(b));
+}
+
+TEST_F(NAME, lookup_after_adding_more_commands)
+{
+    addCommand("print");
+    index.freeze();
+    EXPECT_THAT(index.lookup("cls").empty(), IsTrue());
+
+    cmd::Command* cls = addCommand("cls");
+    index.freeze();
+    auto overloads = index.lookup("cls");
+    ASSERT_THAT(overloads.size(), Eq(1u));
+    EXPECT_THAT(overloads.front(), Eq(cls));
+}
+
+TEST_F(NAME, lookup_many_commands)
+{
+    std::vector<cmd::Command*> commands;
+    for (int i = 0; i != 5000; ++i)
+        commands.push_back(addCommand("command " + std::to_string(i)));
+    index.freeze();
+
+    for (int i = 0; i != 5000; ++i)
+    {
+        auto overloads = index.lookup("COMMAND " + std::to_string(i));
+        ASSERT_THAT(overloads.size(), Eq(1u));
+        EXPECT_THAT(overloads.front(), Eq(commands[i]));
+    }
+}
+
+TEST_F(NAME, distinct_overloads_dont_conflict)
+{
+    addCommand("position object", {{cmd::Command::Type::Integer, "", ""}});
+    addCommand("position object", {{cmd::Command::Type::Float, "", ""}});
+    index.freeze();
+    EXPECT_THAT(index.findConflicts(), IsFalse());
+}
+
+TEST_F(NAME, non_ascii_bytes_are_matched_exactly)
+{
+    cmd::Command* cafe = addCommand("caf\xc3\xa9");
+    addCommand("caf\xc3\x89");
+    index.freeze();
+
+    auto overloads = index.lookup("CAF\xc3\xa9");
+    ASSERT_THAT(overloads.size(), Eq(1u));
+    EXPECT_THAT(overloads.front(), Eq(cafe));
+}
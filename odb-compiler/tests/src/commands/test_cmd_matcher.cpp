@@ -122,3 +122,68 @@ TEST_F(NAME, match_when_multiple_options_include_spaces_and_non_spaces)
     EXPECT_THAT(result.found, IsTrue());
     EXPECT_THAT(result.matchedLength, Eq(strlen("delete object")));
 }
+
+TEST_F(NAME, incremental_match_empty_db)
+{
+    auto state = matcher->beginMatch();
+
+    EXPECT_THAT(matcher->continueMatch(state, "randomize", 9), IsFalse());
+    EXPECT_THAT(state.found, IsFalse());
+    EXPECT_THAT(state.matchedLength, Eq(0));
+}
+
+TEST_F(NAME, incremental_match_one_word_at_a_time)
+{
+    cmd::CommandIndex cmdIndex;
+    cmdIndex.addCommand(new cmd::Command(nullptr, "DELETE OBJECT COLLISION BOX", "", cmd::Command::Type::Void, {}));
+    cmdIndex.addCommand(new cmd::Command(nullptr, "DELETE OBJECT", "", cmd::Command::Type::Void, {}));
+    cmdIndex.addCommand(new cmd::Command(nullptr, "DELETE OBJECTS", "", cmd::Command::Type::Void, {}));
+    matcher->updateFromIndex(&cmdIndex);
+
+    auto state = matcher->beginMatch();
+
+    EXPECT_THAT(matcher->continueMatch(state, "delete", 6), IsTrue());
+    EXPECT_THAT(state.found, IsFalse());
+    EXPECT_THAT(matcher->continueMatch(state, " Object", 7), IsTrue());
+    EXPECT_THAT(state.found, IsTrue());
+    EXPECT_THAT(state.matchedLength, Eq(strlen("delete object")));
+    EXPECT_THAT(matcher->continueMatch(state, " collision", 10), IsTrue());
+    EXPECT_THAT(state.found, IsFalse());
+    EXPECT_THAT(matcher->continueMatch(state, " box", 4), IsTrue());
+    EXPECT_THAT(state.found, IsTrue());
+    EXPECT_THAT(state.matchedLength, Eq(strlen("delete object collision box")));
+}
+
+TEST_F(NAME, incremental_match_stops_at_first_mismatch)
+{
+    cmd::CommandIndex cmdIndex;
+    cmdIndex.addCommand(new cmd::Command(nullptr, "randomize", "", cmd::Command::Type::Void, {}));
+    cmdIndex.addCommand(new cmd::Command(nullptr, "randomize matrix", "", cmd::Command::Type::Void, {}));
+    matcher->updateFromIndex(&cmdIndex);
+
+    auto state = matcher->beginMatch();
+
+    EXPECT_THAT(matcher->continueMatch(state, "randomize", 9), IsTrue());
+    EXPECT_THAT(state.found, IsTrue());
+    EXPECT_THAT(matcher->continueMatch(state, " mesh", 5), IsFalse());
+    EXPECT_THAT(state.found, IsFalse());
+    EXPECT_THAT(state.matchedLength, Eq(strlen("randomize m")));
+}
+
+TEST_F(NAME, non_ascii_bytes)
+{
+    cmd::CommandIndex cmdIndex;
+    cmdIndex.addCommand(new cmd::Command(nullptr, "cafe", "", cmd::Command::Type::Void, {}));
+    cmdIndex.addCommand(new cmd::Command(nullptr, "caf\xc3\xa9", "", cmd::Command::Type::Void, {}));
+    cmdIndex.addCommand(new cmd::Command(nullptr, "caf\xc3\xa9 au lait", "", cmd::Command::Type::Void, {}));
+    cmdIndex.addCommand(new cmd::Command(nullptr, "cafz", "", cmd::Command::Type::Void, {}));
+    matcher->updateFromIndex(&cmdIndex);
+
+    auto result = matcher->findLongestCommandMatching("CAF\xc3\xa9 au lait");
+    EXPECT_THAT(result.found, IsTrue());
+    EXPECT_THAT(result.matchedLength, Eq(13));
+
+    result = matcher->findLongestCommandMatching("cafz");
+    EXPECT_THAT(result.found, IsTrue());
+    EXPECT_THAT(result.matchedLength, Eq(4));
+}
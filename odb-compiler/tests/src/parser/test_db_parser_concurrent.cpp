@@ -0,0 +1,91 @@
+#include "odb-compiler/ast/Block.hpp"
+#include "odb-compiler/commands/Command.hpp"
+#include "odb-compiler/commands/CommandIndex.hpp"
+#include "odb-compiler/commands/CommandMatcher.hpp"
+#include "odb-compiler/ir/SemanticChecker.hpp"
+#include "odb-compiler/parsers/db/Driver.hpp"
+#include "gmock/gmock.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define NAME db_parser_concurrent
+
+using namespace testing;
+using namespace odb;
+
+/*
+ * Many compilations share one command index and matcher. Run this with
+ * ODB_SANITIZE_THREAD=ON to check that sharing them is race free.
+ */
+
+namespace {
+std::string makeProgram(int n)
+{
+    std::string count = std::to_string(n % 50 + 1);
+    return
+        "total = 0\n"
+        "for i = 1 to " + count + "\n"
+        "    if i > 10\n"
+        "        total = total + i * 2\n"
+        "    else\n"
+        "        total = total - 1\n"
+        "    endif\n"
+        "next i\n"
+        "while total > 100\n"
+        "    total = total / 2\n"
+        "endwhile\n"
+        "print total\n"
+        "print wrap value(total, " + count + ")\n";
+}
+}
+
+TEST(NAME, parse_and_check_many_programs_against_one_index)
+{
+    using Type = cmd::Command::Type;
+
+    cmd::CommandIndex cmdIndex;
+    cmdIndex.addCommand(new cmd::Command(nullptr, "print", "dbPrint", Type::Void, {{Type::Integer, "value", ""}}));
+    cmdIndex.addCommand(new cmd::Command(nullptr, "wrap value", "dbWrapValue", Type::Integer,
+                                         {{Type::Integer, "value", ""}, {Type::Integer, "range", ""}}));
+    cmdIndex.freeze();
+
+    cmd::CommandMatcher matcher;
+    matcher.updateFromIndex(&cmdIndex);
+
+    const int threadCount = 8;
+    const int programsPerThread = 50;
+    std::atomic<int> parseFailures(0);
+    std::atomic<int> semanticFailures(0);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t != threadCount; ++t)
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i != programsPerThread; ++i)
+            {
+                // Copying the command list references every command from
+                // every thread at the same time
+                std::vector<Reference<cmd::Command>> commands = cmdIndex.commands();
+
+                db::StringParserDriver driver;
+                Reference<ast::Block> ast = driver.parse("test", makeProgram(t * programsPerThread + i), matcher);
+                if (ast.isNull())
+                {
+                    parseFailures++;
+                    continue;
+                }
+
+                if (ir::runSemanticChecks(ast, cmdIndex) == nullptr)
+                    semanticFailures++;
+            }
+        });
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    EXPECT_THAT(parseFailures.load(), Eq(0));
+    EXPECT_THAT(semanticFailures.load(), Eq(0));
+    for (const auto& command : cmdIndex.commands())
+        EXPECT_THAT(command->refs(), Eq(1));
+}
@@ -0,0 +1,113 @@
+#include "gmock/gmock.h"
+#include "odb-compiler/ast/Arena.hpp"
+#include "odb-compiler/ast/SourceLocation.hpp"
+#include <thread>
+#include <vector>
+
+#define NAME Arena
+
+using namespace testing;
+using namespace odb;
+using namespace odb::ast;
+
+TEST(NAME, no_current_arena_outside_of_scope)
+{
+    EXPECT_THAT(Arena::current(), IsNull());
+    {
+        ArenaScope scope;
+        EXPECT_THAT(Arena::current(), NotNull());
+    }
+    EXPECT_THAT(Arena::current(), IsNull());
+}
+
+TEST(NAME, nested_scopes_restore_previous_arena)
+{
+    ArenaScope outer;
+    Arena* outerArena = Arena::current();
+    {
+        ArenaScope inner;
+        EXPECT_THAT(Arena::current(), Ne(outerArena));
+    }
+    EXPECT_THAT(Arena::current(), Eq(outerArena));
+}
+
+TEST(NAME, heap_allocation_outside_of_scope)
+{
+    Reference<SourceLocation> loc = new InlineSourceLocation("test", "a = 1", 1, 1, 1, 6);
+    EXPECT_THAT(loc->getFileLineColumn(), StrEq("test:1:1"));
+}
+
+TEST(NAME, objects_outlive_scope)
+{
+    std::size_t arenasBefore = Arena::liveArenaCount();
+    std::vector<Reference<SourceLocation>> locs;
+    Arena* arena;
+    {
+        ArenaScope scope;
+        arena = Arena::current();
+        for (int i = 1; i != 10000; ++i)
+            locs.push_back(new InlineSourceLocation("test", "a = 1", 1, 1, 1, i + 1));
+    }
+
+    EXPECT_THAT(Arena::liveArenaCount(), Eq(arenasBefore + 1));
+    EXPECT_THAT(arena->liveObjectCount(), Eq(9999u));
+    for (int i = 1; i != 10000; ++i)
+        EXPECT_THAT(locs[i - 1]->lastColumn(), Eq(i + 1));
+
+    locs.pop_back();
+    EXPECT_THAT(arena->liveObjectCount(), Eq(9998u));
+
+    // Releasing the last object frees the arena
+    locs.clear();
+    EXPECT_THAT(Arena::liveArenaCount(), Eq(arenasBefore));
+}
+
+TEST(NAME, objects_released_in_any_order)
+{
+    std::vector<Reference<SourceLocation>> locs;
+    {
+        ArenaScope scope;
+        for (int i = 0; i != 100; ++i)
+            locs.push_back(new InlineSourceLocation("test", "a = 1", 1, 1, 1, 2));
+    }
+
+    for (int i = 0; i < 100; i += 2)
+        locs[i].reset();
+    Reference<SourceLocation> last = locs[99];
+    locs.clear();
+    EXPECT_THAT(last->getFileLineColumn(), StrEq("test:1:1"));
+}
+
+TEST(NAME, objects_released_before_scope_ends)
+{
+    std::size_t arenasBefore = Arena::liveArenaCount();
+    {
+        ArenaScope scope;
+        Reference<SourceLocation> loc = new InlineSourceLocation("test", "a = 1", 1, 1, 1, 2);
+        EXPECT_THAT(Arena::current()->liveObjectCount(), Eq(1u));
+        loc.reset();
+
+        // The scope keeps the arena alive even though it holds no objects
+        EXPECT_THAT(Arena::current()->liveObjectCount(), Eq(0u));
+        EXPECT_THAT(Arena::liveArenaCount(), Eq(arenasBefore + 1));
+    }
+    EXPECT_THAT(Arena::liveArenaCount(), Eq(arenasBefore));
+}
+
+TEST(NAME, objects_released_on_another_thread)
+{
+    std::size_t arenasBefore = Arena::liveArenaCount();
+    std::vector<Reference<SourceLocation>> locs;
+    {
+        ArenaScope scope;
+        for (int i = 0; i != 1000; ++i)
+            locs.push_back(new InlineSourceLocation("test", "a = 1", 1, 1, 1, 2));
+    }
+
+    std::vector<Reference<SourceLocation>> otherLocs(locs.begin() + 500, locs.end());
+    locs.resize(500);
+    std::thread thread([&otherLocs] { otherLocs.clear(); });
+    locs.clear();
+    thread.join();
+    EXPECT_THAT(Arena::liveArenaCount(), Eq(arenasBefore));
+}
@@ -0,0 +1,149 @@
+#include "gmock/gmock.h"
+#include "odb-compiler/ast/Arena.hpp"
+#include "odb-compiler/ast/SourceLocation.hpp"
+#include "odb-sdk/MemReport.hpp"
+#include <cstdio>
+
+#define NAME mem_report
+
+using namespace testing;
+using namespace odb;
+using namespace odb::ast;
+
+class NAME : public Test
+{
+public:
+    void SetUp() override
+    {
+        MemReport::reset();
+        MemReport::enable();
+    }
+
+    void TearDown() override
+    {
+        MemReport::disable();
+        MemReport::reset();
+    }
+};
+
+namespace {
+class Object : public RefCounted
+{
+};
+
+std::string readAll(FILE* fp)
+{
+    std::rewind(fp);
+    std::string str;
+    char buffer[4096];
+    for (std::size_t n; (n = std::fread(buffer, 1, sizeof(buffer), fp)) > 0;)
+        str.append(buffer, n);
+    return str;
+}
+}
+
+TEST_F(NAME, source_locations_are_counted_with_their_size)
+{
+    MemReport::Stats before = MemReport::stats(MemCategory::SourceLocation);
+
+    Reference<SourceLocation> loc = new InlineSourceLocation("test", "a = 1", 1, 1, 1, 6);
+    MemReport::Stats during = MemReport::stats(MemCategory::SourceLocation);
+    EXPECT_THAT(during.created, Eq(before.created + 1));
+    EXPECT_THAT(during.live, Eq(before.live + 1));
+    EXPECT_THAT(during.liveBytes, Eq(before.liveBytes + (std::int64_t)sizeof(InlineSourceLocation)));
+    EXPECT_THAT(during.peakLive, Ge(during.live));
+
+    loc.reset();
+    MemReport::Stats after = MemReport::stats(MemCategory::SourceLocation);
+    EXPECT_THAT(after.created, Eq(before.created + 1));
+    EXPECT_THAT(after.live, Eq(before.live));
+    EXPECT_THAT(after.liveBytes, Eq(before.liveBytes));
+}
+
+TEST_F(NAME, arena_chunks_are_counted_until_arena_is_freed)
+{
+    MemReport::Stats before = MemReport::stats(MemCategory::ASTArena);
+
+    Reference<SourceLocation> loc;
+    {
+        ArenaScope scope;
+        loc = new InlineSourceLocation("test", "a = 1", 1, 1, 1, 6);
+    }
+    MemReport::Stats during = MemReport::stats(MemCategory::ASTArena);
+    EXPECT_THAT(during.live, Eq(before.live + 1));
+    EXPECT_THAT(during.liveBytes, Gt(before.liveBytes));
+
+    loc.reset();
+    MemReport::Stats after = MemReport::stats(MemCategory::ASTArena);
+    EXPECT_THAT(after.live, Eq(before.live));
+    EXPECT_THAT(after.liveBytes, Eq(before.liveBytes));
+}
+
+TEST_F(NAME, ref_counted_objects_are_counted)
+{
+    MemReport::Stats before = MemReport::stats(MemCategory::RefCounted);
+    {
+        Reference<Object> a = new Object;
+        Reference<Object> b = new Object;
+        EXPECT_THAT(MemReport::stats(MemCategory::RefCounted).live, Eq(before.live + 2));
+    }
+    MemReport::Stats after = MemReport::stats(MemCategory::RefCounted);
+    EXPECT_THAT(after.created, Eq(before.created + 2));
+    EXPECT_THAT(after.live, Eq(before.live));
+}
+
+TEST_F(NAME, created_objects_dont_affect_live_count)
+{
+    MemReport::Stats before = MemReport::stats(MemCategory::LLVMInstruction);
+    MemReport::addCreated(MemCategory::LLVMInstruction, 10, 640);
+    MemReport::Stats after = MemReport::stats(MemCategory::LLVMInstruction);
+    EXPECT_THAT(after.created, Eq(before.created + 10));
+    EXPECT_THAT(after.createdBytes, Eq(before.createdBytes + 640));
+    EXPECT_THAT(after.live, Eq(before.live));
+}
+
+TEST_F(NAME, phases_and_categories_are_written_to_json)
+{
+    MemReport::recordPhase("phases_and_categories_are_written_to_json");
+
+    FILE* fp = std::tmpfile();
+    ASSERT_THAT(fp, NotNull());
+    MemReport::writeJSON(fp);
+    std::string json = readAll(fp);
+    std::fclose(fp);
+
+    EXPECT_THAT(json, StartsWith("{\"peakRSS\":"));
+    EXPECT_THAT(json, HasSubstr("\"ASTNode\":{\"created\":"));
+    EXPECT_THAT(json, HasSubstr("\"RefCounted\":{\"created\":"));
+    EXPECT_THAT(json, HasSubstr("\"createdBytes\":null"));
+    EXPECT_THAT(json, HasSubstr("{\"name\":\"phases_and_categories_are_written_to_json\",\"peakRSS\":"));
+    EXPECT_THAT(json, EndsWith("]}\n"));
+}
+
+TEST_F(NAME, phase_counts_arena_chunks_but_not_the_nodes_inside)
+{
+    Reference<SourceLocation> loc;
+    {
+        ArenaScope scope;
+        loc = new InlineSourceLocation("test", "a = 1", 1, 1, 1, 6);
+    }
+    MemReport::recordPhase("phase_counts_arena_chunks_but_not_the_nodes_inside");
+
+    MemReport::Stats chunks = MemReport::stats(MemCategory::ASTArena);
+    ASSERT_THAT(chunks.live, Eq(1));
+    EXPECT_THAT(MemReport::stats(MemCategory::SourceLocation).liveBytes, Gt(0));
+    ASSERT_THAT(MemReport::phases().size(), Eq(1u));
+    EXPECT_THAT(MemReport::phases()[0].trackedBytes, Eq(chunks.liveBytes));
+}
+
+TEST_F(NAME, objects_created_before_enabling_dont_make_counts_negative)
+{
+    MemReport::disable();
+    Reference<SourceLocation> loc = new InlineSourceLocation("test", "a = 1", 1, 1, 1, 6);
+    MemReport::enable();
+
+    loc.reset();
+    MemReport::Stats after = MemReport::stats(MemCategory::SourceLocation);
+    EXPECT_THAT(after.live, Eq(0));
+    EXPECT_THAT(after.liveBytes, Eq(0));
+}
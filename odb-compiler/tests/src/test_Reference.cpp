@@ -0,0 +1,108 @@
+#include "gmock/gmock.h"
+#include "odb-sdk/Reference.hpp"
+#include <vector>
+
+#define NAME Reference
+
+using namespace testing;
+using namespace odb;
+
+namespace {
+class Object : public RefCounted
+{
+public:
+    Object(int* destroyed) : destroyed_(destroyed) {}
+    ~Object() { (*destroyed_)++; }
+
+private:
+    int* destroyed_;
+};
+}
+
+TEST(NAME, weak_control_block_is_allocated_on_demand)
+{
+    int destroyed = 0;
+    Reference<Object> obj = new Object(&destroyed);
+    EXPECT_THAT(obj.refs(), Eq(1));
+    EXPECT_THAT(obj.weakRefs(), Eq(0));
+
+    WeakReference<Object> weak(obj);
+    EXPECT_THAT(obj.weakRefs(), Eq(1));
+    EXPECT_THAT(weak.refs(), Eq(1));
+    EXPECT_THAT(weak.expired(), IsFalse());
+}
+
+TEST(NAME, weak_reference_outlives_object)
+{
+    int destroyed = 0;
+    Reference<Object> obj = new Object(&destroyed);
+    WeakReference<Object> weak(obj);
+
+    obj.reset();
+    EXPECT_THAT(destroyed, Eq(1));
+    EXPECT_THAT(weak.expired(), IsTrue());
+    EXPECT_THAT(weak.refs(), Eq(0));
+    EXPECT_THAT(weak.lock().isNull(), IsTrue());
+}
+
+TEST(NAME, move_construct_leaves_refcount_untouched)
+{
+    int destroyed = 0;
+    Reference<Object> a = new Object(&destroyed);
+    Reference<Object> b(std::move(a));
+    EXPECT_THAT(a.isNull(), IsTrue());
+    EXPECT_THAT(b.refs(), Eq(1));
+
+    Reference<RefCounted> c(std::move(b));
+    EXPECT_THAT(b.isNull(), IsTrue());
+    EXPECT_THAT(c.refs(), Eq(1));
+    EXPECT_THAT(destroyed, Eq(0));
+}
+
+TEST(NAME, move_assign_releases_previous_object)
+{
+    int destroyed = 0;
+    Reference<Object> a = new Object(&destroyed);
+    Reference<Object> b = new Object(&destroyed);
+    b = std::move(a);
+    EXPECT_THAT(destroyed, Eq(1));
+    EXPECT_THAT(a.isNull(), IsTrue());
+    EXPECT_THAT(b.refs(), Eq(1));
+}
+
+TEST(NAME, move_assign_same_object)
+{
+    int destroyed = 0;
+    Reference<Object> a = new Object(&destroyed);
+    Reference<Object> b = a;
+    b = std::move(a);
+    EXPECT_THAT(destroyed, Eq(0));
+    EXPECT_THAT(b.refs(), Eq(1));
+}
+
+TEST(NAME, vector_growth_does_not_touch_refcounts)
+{
+    int destroyed = 0;
+    std::vector<Reference<Object>> objs;
+    for (int i = 0; i != 100; ++i)
+        objs.push_back(new Object(&destroyed));
+    for (const auto& obj : objs)
+        EXPECT_THAT(obj.refs(), Eq(1));
+
+    objs.clear();
+    EXPECT_THAT(destroyed, Eq(100));
+}
+
+TEST(NAME, detach_keeps_object_alive)
+{
+    int destroyed = 0;
+    Reference<Object> a = new Object(&destroyed);
+    Object* raw = a;
+    a.detach();
+    EXPECT_THAT(a.isNull(), IsTrue());
+    EXPECT_THAT(raw->refs(), Eq(0));
+    EXPECT_THAT(destroyed, Eq(0));
+
+    TouchRef(raw);
+    EXPECT_THAT(destroyed, Eq(1));
+}
@@ -1,5 +1,7 @@
 #include "gmock/gmock.h"
 #include "odb-compiler/ast/SourceLocation.hpp"
+#include <filesystem>
+#include <fstream>
 
 #define NAME SourceLocation
 
@@ -315,3 +317,123 @@ TEST(NAME, unionize_lines_and_columns_6)
     EXPECT_THAT(sl2.firstColumn(), Eq(1));
     EXPECT_THAT(sl2.lastColumn(), Eq(5));
 }
+
+TEST(NAME, duplicate_shares_source_buffer)
+{
+    odb::Reference<SourceBuffer> source = new InlineSourceBuffer("test", "some command 1, 2, 3");
+    SourceLocation sl1(source, 1, 1, 4, 8);
+    odb::Reference<SourceLocation> sl2 = sl1.duplicate();
+    EXPECT_THAT(sl2->source(), Eq(source.get()));
+    EXPECT_THAT(sl2->getFileLineColumn(), StrEq("test:1:4"));
+
+    std::vector<std::string> sh = sl2->getUnderlinedSection();
+    EXPECT_THAT(sh[0], StrEq("some command 1, 2, 3"));
+    EXPECT_THAT(sh[1], StrEq("   ^~~~"));
+}
+
+TEST(NAME, file_location_is_read_once)
+{
+    std::string fileName = (std::filesystem::temp_directory_path() / "odb_test_SourceLocation.dba").string();
+    {
+        std::ofstream file(fileName);
+        file << "some command 1, 2, 3\nanother command 4, 5, 6\n";
+    }
+
+    odb::Reference<SourceBuffer> source = new FileSourceBuffer(fileName);
+    SourceLocation sl1(source, 2, 2, 4, 8);
+    std::vector<std::string> sh = sl1.getUnderlinedSection();
+    EXPECT_THAT(sh[0], StrEq("another command 4, 5, 6"));
+    EXPECT_THAT(sh[1], StrEq("   ^~~~"));
+
+    // Locations sharing the buffer no longer need the file on disk
+    std::filesystem::remove(fileName);
+    SourceLocation sl2(source, 1, 1, 2, 3);
+    sh = sl2.getUnderlinedSection();
+    EXPECT_THAT(sh[0], StrEq("some command 1, 2, 3"));
+    EXPECT_THAT(sh[1], StrEq(" ^"));
+}
+
+TEST(NAME, file_location_is_unaffected_by_modified_scanner_input)
+{
+    std::string fileName = (std::filesystem::temp_directory_path() / "odb_test_SourceLocation_mapped.dba").string();
+    {
+        std::ofstream file(fileName);
+        file << "some command 1, 2, 3\nanother command 4, 5, 6";
+    }
+
+    // The scanner's private copy is zero padded and can be modified without
+    // affecting what diagnostics see
+    odb::Reference<odb::MappedFile> input = odb::MappedFile::openPrivate(fileName.c_str(), 2);
+    ASSERT_THAT(input.notNull(), IsTrue());
+    EXPECT_THAT(input->writableData()[input->size()], Eq('\0'));
+    EXPECT_THAT(input->writableData()[input->size() + 1], Eq('\0'));
+    input->writableData()[20] = '\0';
+
+    odb::Reference<SourceBuffer> source = new FileSourceBuffer(fileName);
+    SourceLocation sl(source, 1, 2, 6, 8);
+    std::vector<std::string> sh = sl.getUnderlinedSection();
+    std::filesystem::remove(fileName);
+    EXPECT_THAT(sh[0], StrEq("some command 1, 2, 3"));
+    EXPECT_THAT(sh[1], StrEq("     ^~~~~~~~~~~~~~~"));
+    EXPECT_THAT(sh[2], StrEq("another command 4, 5, 6"));
+    EXPECT_THAT(sh[3], StrEq("~~~~~~~"));
+}
+
+TEST(NAME, offsets_are_converted_to_line_and_column)
+{
+    odb::Reference<SourceBuffer> source = new InlineSourceBuffer("test", "ab\ncd\n\nef");
+    int line, column;
+
+    ASSERT_THAT(source->getLineColumn(0, &line, &column), IsTrue());
+    EXPECT_THAT(line, Eq(1)); EXPECT_THAT(column, Eq(1));
+    ASSERT_THAT(source->getLineColumn(2, &line, &column), IsTrue());
+    EXPECT_THAT(line, Eq(1)); EXPECT_THAT(column, Eq(3));
+    ASSERT_THAT(source->getLineColumn(3, &line, &column), IsTrue());
+    EXPECT_THAT(line, Eq(2)); EXPECT_THAT(column, Eq(1));
+    ASSERT_THAT(source->getLineColumn(6, &line, &column), IsTrue());
+    EXPECT_THAT(line, Eq(3)); EXPECT_THAT(column, Eq(1));
+    ASSERT_THAT(source->getLineColumn(8, &line, &column), IsTrue());
+    EXPECT_THAT(line, Eq(4)); EXPECT_THAT(column, Eq(2));
+
+    // One past the end is where the last token ends
+    ASSERT_THAT(source->getLineColumn(9, &line, &column), IsTrue());
+    EXPECT_THAT(line, Eq(4)); EXPECT_THAT(column, Eq(3));
+}
+
+TEST(NAME, indexed_file_resolves_offsets_without_reading_the_file)
+{
+    std::string fileName = (std::filesystem::temp_directory_path() / "odb-test-indexed.dba").string();
+    odb::Reference<SourceBuffer> source = new FileSourceBuffer(fileName);
+    source->indexLines("ab\ncd");
+
+    // The file doesn't exist, so this only works if the index is used
+    int line, column;
+    ASSERT_THAT(source->getLineColumn(4, &line, &column), IsTrue());
+    EXPECT_THAT(line, Eq(2)); EXPECT_THAT(column, Eq(2));
+
+    std::string_view code;
+    EXPECT_THAT(source->getLine(1, &code), IsFalse());
+}
+
+TEST(NAME, offsets_are_resolved_on_first_access)
+{
+    odb::Reference<SourceBuffer> source = new InlineSourceBuffer("test", "ab\ncd\n\nef");
+    SourceLocation sl(source, 1, 9);
+
+    EXPECT_THAT(sl.getFileLineColumn(), StrEq("test:1:2"));
+    EXPECT_THAT(sl.getLineColumnExtents(), StrEq("1-4:2-3"));
+
+    odb::Reference<SourceLocation> copy = sl.duplicate();
+    EXPECT_THAT(copy->lastLine(), Eq(4));
+    EXPECT_THAT(copy->lastColumn(), Eq(3));
+}
+
+TEST(NAME, unresolved_locations_can_be_unionized)
+{
+    odb::Reference<SourceBuffer> source = new InlineSourceBuffer("test", "ab\ncd\n\nef");
+    SourceLocation first(source, 3, 5);
+    SourceLocation second(source, 1, 4);
+    first.unionize(&second);
+
+    EXPECT_THAT(first.getLineColumnExtents(), StrEq("1-2:2-3"));
+}
@@ -0,0 +1,71 @@
+#include "gmock/gmock.h"
+#include "odb-sdk/Log.hpp"
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#define NAME thread_log_buffer
+
+using namespace testing;
+using namespace odb;
+
+namespace {
+std::string readAll(FILE* file)
+{
+    std::string result;
+    char buffer[256];
+    std::size_t bytesRead;
+    std::fflush(file);
+    std::rewind(file);
+    while ((bytesRead = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        result.append(buffer, bytesRead);
+    return result;
+}
+}
+
+TEST(NAME, messages_are_written_in_flush_order)
+{
+    FILE* out = std::tmpfile();
+    ASSERT_THAT(out, NotNull());
+    Log log(out);
+
+    ThreadLogBuffer first, second;
+    std::thread thread([&]() {
+        second.begin();
+        log.print("second\n");
+        second.end();
+    });
+    thread.join();
+    first.begin();
+    log.print("first\n");
+    first.end();
+
+    EXPECT_THAT(readAll(out), StrEq(""));
+    first.flush(log);
+    second.flush(log);
+    EXPECT_THAT(readAll(out), StrEq("first\nsecond\n"));
+    std::fclose(out);
+}
+
+TEST(NAME, end_restores_previous_redirect)
+{
+    FILE* out = std::tmpfile();
+    FILE* outer = std::tmpfile();
+    ASSERT_THAT(out, NotNull());
+    ASSERT_THAT(outer, NotNull());
+    Log log(out);
+
+    Log::redirectThread(outer);
+    ThreadLogBuffer buffer;
+    buffer.begin();
+    log.print("inner\n");
+    buffer.end();
+    log.print("outer\n");
+    buffer.flush(log);
+    Log::redirectThread(nullptr);
+
+    EXPECT_THAT(readAll(out), StrEq(""));
+    EXPECT_THAT(readAll(outer), StrEq("outer\ninner\n"));
+    std::fclose(outer);
+    std::fclose(out);
+}
@@ -0,0 +1,128 @@
+#include "gmock/gmock.h"
+#include "odb-sdk/TimeReport.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#define NAME time_report
+
+using namespace testing;
+using namespace odb;
+
+class NAME : public Test
+{
+public:
+    void SetUp() override
+    {
+        TimeReport::reset();
+        TimeReport::enable();
+    }
+
+    void TearDown() override
+    {
+        TimeReport::disable();
+        TimeReport::reset();
+    }
+};
+
+namespace {
+std::vector<TimeReport::Event> eventsNamed(const std::string& name)
+{
+    std::vector<TimeReport::Event> events = TimeReport::events();
+    events.erase(std::remove_if(events.begin(), events.end(),
+        [&name](const TimeReport::Event& event) { return event.name != name; }), events.end());
+    return events;
+}
+}
+
+TEST_F(NAME, scoped_timer_records_one_event)
+{
+    {
+        ScopedTimer timer("test", "scoped_timer_records_one_event");
+    }
+
+    auto events = eventsNamed("scoped_timer_records_one_event");
+    ASSERT_THAT(events.size(), Eq(1u));
+    EXPECT_THAT(events[0].category, StrEq("test"));
+    EXPECT_THAT(events[0].start, Ge(0));
+    EXPECT_THAT(events[0].duration, Ge(0));
+}
+
+TEST_F(NAME, nested_timers_are_contained_in_outer_timer)
+{
+    {
+        ScopedTimer outer("test", "nested_outer");
+        ScopedTimer inner("test", "nested_inner");
+    }
+
+    auto outer = eventsNamed("nested_outer");
+    auto inner = eventsNamed("nested_inner");
+    ASSERT_THAT(outer.size(), Eq(1u));
+    ASSERT_THAT(inner.size(), Eq(1u));
+    EXPECT_THAT(inner[0].start, Ge(outer[0].start));
+    EXPECT_THAT(inner[0].start + inner[0].duration, Le(outer[0].start + outer[0].duration));
+}
+
+TEST_F(NAME, each_thread_gets_its_own_id)
+{
+    auto record = []() { ScopedTimer timer("test", "each_thread_gets_its_own_id"); };
+    std::thread t1(record);
+    t1.join();
+    std::thread t2(record);
+    t2.join();
+    record();
+
+    auto events = eventsNamed("each_thread_gets_its_own_id");
+    ASSERT_THAT(events.size(), Eq(3u));
+    EXPECT_THAT(events[0].threadId, Ne(events[1].threadId));
+    EXPECT_THAT(events[0].threadId, Ne(events[2].threadId));
+    EXPECT_THAT(events[1].threadId, Ne(events[2].threadId));
+}
+
+TEST_F(NAME, chrome_trace_escapes_names)
+{
+    {
+        ScopedTimer timer("test", "file \"with quotes\"\\.dba");
+    }
+
+    FILE* fp = std::tmpfile();
+    ASSERT_THAT(fp, NotNull());
+    TimeReport::writeChromeTrace(fp);
+    std::rewind(fp);
+    std::string trace;
+    char buffer[4096];
+    for (std::size_t n; (n = std::fread(buffer, 1, sizeof(buffer), fp)) > 0;)
+        trace.append(buffer, n);
+    std::fclose(fp);
+
+    EXPECT_THAT(trace, StartsWith("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    EXPECT_THAT(trace, HasSubstr("{\"name\":\"file \\\"with quotes\\\"\\\\.dba\",\"cat\":\"test\",\"ph\":\"X\""));
+    EXPECT_THAT(trace, EndsWith("]}\n"));
+}
+
+TEST_F(NAME, disabled_timers_record_nothing)
+{
+    TimeReport::disable();
+    {
+        ScopedTimer timer("test", "disabled_timers_record_nothing");
+    }
+
+    EXPECT_THAT(TimeReport::events(), IsEmpty());
+}
+
+TEST_F(NAME, take_thread_events_keeps_other_threads)
+{
+    std::thread other([] { ScopedTimer timer("test", "other_thread"); });
+    other.join();
+    {
+        ScopedTimer timer("test", "this_thread");
+    }
+
+    auto taken = TimeReport::takeThreadEvents();
+    ASSERT_THAT(taken.size(), Eq(1u));
+    EXPECT_THAT(taken[0].name, StrEq("this_thread"));
+
+    auto remaining = TimeReport::events();
+    ASSERT_THAT(remaining.size(), Eq(1u));
+    EXPECT_THAT(remaining[0].name, StrEq("other_thread"));
+}
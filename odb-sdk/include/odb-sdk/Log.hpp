@@ -82,6 +82,14 @@ public:
 
     bool colorEnabled() const;
 
+    /*!
+     * Redirects everything the calling thread writes to any log to another
+     * stream. Pass null to write to each log's own stream again. Used to
+     * collect the messages of one compilation while others run on other
+     * threads.
+     */
+    static void redirectThread(FILE* stream);
+
     static void dbParserFailedToOpenFile(const char* fileName);
     static void dbParserNotice(const char* fmt, ...);
     static void dbParserError(const char* fmt, ...);
@@ -106,6 +114,9 @@ public:
 private:
     friend class ColorState;
 
+    FILE* stream() const;
+    Color* colorState();
+
     FILE* stream_ = nullptr;
     Color color_ = RESET;
     bool enableColor_ = true;
@@ -125,4 +136,33 @@ private:
     Log::Color saveColor_;
 };
 
+/*!
+ * @brief Collects everything the calling thread logs between begin() and
+ * end(), so the messages of work done in parallel can be printed in a fixed
+ * order once it is done. If no buffer can be created, messages are written
+ * to the logs directly instead.
+ */
+class ODBSDK_PUBLIC_API ThreadLogBuffer
+{
+public:
+    ThreadLogBuffer();
+    ~ThreadLogBuffer();
+
+    ThreadLogBuffer(const ThreadLogBuffer&) = delete;
+    ThreadLogBuffer& operator=(const ThreadLogBuffer&) = delete;
+
+    //! Redirects the calling thread's logs into the buffer
+    void begin();
+    //! Sends the calling thread's logs back to where they went before begin()
+    void end();
+
+    //! Writes the collected messages to the log's stream and empties the buffer
+    void flush(Log& log);
+
+private:
+    FILE* file_;
+    FILE* previousStream_;
+    Log::Color previousColor_;
+};
+
 }
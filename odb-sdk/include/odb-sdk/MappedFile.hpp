@@ -0,0 +1,66 @@
+#pragma once
+
+#include "odb-sdk/config.hpp"
+#include "odb-sdk/RefCounted.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace odb {
+
+struct MappedFilePlatformData;
+
+/*!
+ * @brief Maps a file read-only into memory. Pages are only read from disk
+ * once they are accessed, and the mapping is released when the last
+ * reference goes away.
+ */
+class ODBSDK_PUBLIC_API MappedFile : public RefCounted
+{
+public:
+    MappedFile() = delete;
+    ~MappedFile();
+
+    /*!
+     * @brief Attempts to map the specified file.
+     * @return Returns nullptr on failure, otherwise returns a new instance of
+     * this class.
+     */
+    static MappedFile* open(const char* filename);
+
+    /*!
+     * @brief Maps the specified file copy-on-write, followed by at least
+     * zeroPadding zero bytes. Changes made through writableData() are private
+     * to the mapping and never reach the file. Only the pages that are
+     * written to are copied.
+     * @return Returns nullptr on failure, otherwise returns a new instance of
+     * this class.
+     */
+    static MappedFile* openPrivate(const char* filename, std::size_t zeroPadding);
+
+    const char* getFilename() const;
+
+    /*!
+     * @brief Returns a pointer to the start of the file's contents. May be
+     * nullptr if the file is empty.
+     */
+    const char* data() const;
+
+    /*!
+     * @brief Returns a writable pointer to the file's contents if the file was
+     * opened with openPrivate(), otherwise nullptr.
+     */
+    char* writableData();
+
+    /*!
+     * @brief Returns the size of the file. Padding is not included.
+     */
+    std::size_t size() const;
+
+private:
+    explicit MappedFile(std::unique_ptr<MappedFilePlatformData> data, const std::string& filename);
+    std::unique_ptr<MappedFilePlatformData> data_;
+    const std::string filename_;
+};
+
+}
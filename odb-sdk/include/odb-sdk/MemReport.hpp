@@ -0,0 +1,117 @@
+#pragma once
+
+#include "odb-sdk/config.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace odb {
+
+enum class MemCategory : int
+{
+    //! Every object derived from RefCounted. Only counted, their size isn't known to the base class.
+    RefCounted,
+    ASTNode,
+    SourceLocation,
+    //! Chunks reserved by ast::Arena, which hold the AST nodes and locations of one parse
+    ASTArena,
+    //! IR nodes allocated on the heap. Includes variables.
+    IRNode,
+    IRVariable,
+    //! Counted once per generated module. The size is an estimate based on each instruction's operands.
+    LLVMInstruction,
+
+    Count
+};
+
+/*!
+ * @brief Counts the objects a compilation creates and how many bytes they
+ * hold, and samples the process' peak RSS at the end of each phase.
+ *
+ * Counting is off until enable() is called, until then each hook only
+ * checks a flag. It should be enabled before the first object is tracked.
+ * Objects that already existed when counting was enabled or reset are
+ * untracked when they are destroyed, which can make the live counts too
+ * low. They are clamped so they never go negative.
+ */
+class ODBSDK_PUBLIC_API MemReport
+{
+public:
+    struct Stats
+    {
+        std::int64_t created;
+        std::int64_t createdBytes;
+        std::int64_t live;
+        std::int64_t liveBytes;
+        std::int64_t peakLive;
+        std::int64_t peakLiveBytes;
+    };
+
+    struct Phase
+    {
+        std::string name;
+        std::size_t peakRSS;
+        /*!
+         * Sum of the live bytes at the end of the phase. Categories whose
+         * memory is part of another one are left out: AST nodes and
+         * locations are counted through the arena chunks that hold them, and
+         * IR variables as IR nodes. AST objects allocated outside of an
+         * arena are therefore not included.
+         */
+        std::int64_t trackedBytes;
+    };
+
+    static void enable();
+    static void disable();
+    static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+    //! Called when an object of a category is created
+    static void track(MemCategory category, std::size_t bytes)
+    {
+        if (enabled())
+            add(category, 1, (std::int64_t)bytes);
+    }
+
+    //! Called when an object of a category is destroyed
+    static void untrack(MemCategory category, std::size_t bytes)
+    {
+        if (enabled())
+            add(category, -1, -(std::int64_t)bytes);
+    }
+
+    /*!
+     * @brief Adds objects that are counted all at once and never untracked,
+     * so they don't affect the live counts.
+     */
+    static void addCreated(MemCategory category, std::size_t count, std::size_t bytes);
+
+    //! Sets all counts to zero and discards all phases
+    static void reset();
+
+    //! Samples the peak RSS at the end of a phase. Does nothing unless enabled.
+    static void recordPhase(const char* name);
+
+    static Stats stats(MemCategory category);
+    static std::vector<Phase> phases();
+    static const char* categoryName(MemCategory category);
+
+    /*!
+     * @brief Returns the largest resident set size the process had so far in
+     * bytes, or 0 if the platform doesn't report it.
+     */
+    static std::size_t peakRSS();
+
+    //! Prints all categories and phases to Log::info
+    static void printSummary();
+    static void writeJSON(FILE* fp);
+
+private:
+    static void add(MemCategory category, std::int64_t count, std::int64_t bytes);
+
+    static std::atomic<bool> enabled_;
+};
+
+}
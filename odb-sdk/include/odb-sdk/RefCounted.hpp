@@ -23,10 +23,11 @@
 #pragma once
 
 #include "odb-sdk/config.hpp"
+#include <atomic>
 
 namespace odb {
 
-/// common::Reference< count structure.
+/// Weak reference control block. Only allocated once the first weak reference to an object is created, and outlives the object for as long as weak references to it exist.
 struct ODBSDK_PUBLIC_API RefCount
 {
     /// Construct.
@@ -44,19 +45,31 @@ struct ODBSDK_PUBLIC_API RefCount
         weakRefs_ = -1;
     }
 
-    /// common::Reference< count. If below zero, the object has been destroyed.
+    /// Zero while the object is alive. If below zero, the object has been destroyed. The strong reference count itself is stored in RefCounted.
     int refs_;
     /// Weak reference count.
     int weakRefs_;
 };
 
+/// Selects how the reference count of an object is updated. Chosen by each type in its constructor.
+enum class RefCountPolicy : char
+{
+    /// Plain increments and decrements. An object and all references to it must only be used by one thread at a time.
+    /// This is the default, and is what every object that belongs to a single compilation (AST, IR) uses.
+    SingleThreaded,
+    /// Atomic increments and decrements. References to the object may be created and released concurrently from any
+    /// thread. Used by objects that are built once and then shared read-only between compilations, such as commands
+    /// and plugins. Weak references are not thread-safe and must be created before the object is shared.
+    ThreadSafe
+};
+
 /// Base class for intrusively reference-counted objects. These are noncopyable and non-assignable.
 class ODBSDK_PUBLIC_API RefCounted
 {
 public:
-    /// Construct. Allocate the reference count structure and set an initial self weak reference.
-    RefCounted();
-    /// Destruct. Mark as expired and also delete the reference count structure if no outside weak references exist.
+    /// Construct. No weak reference control block is allocated until one is needed.
+    explicit RefCounted(RefCountPolicy policy = RefCountPolicy::SingleThreaded);
+    /// Destruct. Mark as expired and also delete the weak reference control block if no outside weak references exist.
     virtual ~RefCounted();
     /// Prevent copy construction.
     RefCounted(const RefCounted& rhs) = delete;
@@ -64,19 +77,38 @@ public:
     RefCounted& operator=(const RefCounted& rhs) = delete;
 
     /// Increment reference count. Can also be called outside of a SharedPtr for traditional reference counting.
-    void addRef();
+    void addRef()
+    {
+        // Single threaded objects only ever use relaxed loads and stores, which compile to plain memory accesses
+        if (policy_ == RefCountPolicy::ThreadSafe)
+            refs_.fetch_add(1, std::memory_order_relaxed);
+        else
+            refs_.store(refs_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
     /// Decrement reference count and delete self if no more references. Can also be called outside of a SharedPtr for traditional reference counting.
     void releaseRef();
+    /// Decrement reference count without deleting self if it reaches zero. Used to hand an object over to a raw pointer.
+    void detachRef();
     /// Return reference count.
-    int refs() const;
+    int refs() const { return refs_.load(std::memory_order_relaxed); }
     /// Return weak reference count.
     int weakRefs() const;
 
-    /// Return pointer to the reference count structure.
-    RefCount* refCountPtr() { return refCount_; }
+    /// Return pointer to the weak reference control block, allocating it if this is the first weak reference.
+    RefCount* refCountPtr();
+
+    /// Return how the reference count is updated.
+    RefCountPolicy refCountPolicy() const { return policy_; }
 
 private:
-    /// Pointer to the reference count structure.
+    /// Decrement the reference count and return the new count.
+    int decrementRefs();
+
+    /// Strong reference count.
+    std::atomic<int> refs_;
+    /// Whether refs_ is updated atomically.
+    const RefCountPolicy policy_;
+    /// Pointer to the weak reference control block, or null if no weak reference was ever created.
     RefCount* refCount_;
 };
 
@@ -59,6 +59,21 @@ public:
         addRef();
     }
 
+    /// Move-construct from another shared pointer. The reference count is left untouched.
+    Reference(Reference<T>&& rhs) noexcept :
+        ptr_(rhs.ptr_)
+    {
+        rhs.ptr_ = 0;
+    }
+
+    /// Move-construct from another shared pointer allowing implicit upcasting.
+    template <class U>
+    Reference(Reference<U>&& rhs) noexcept :
+        ptr_(rhs.ptr_)
+    {
+        rhs.ptr_ = 0;
+    }
+
     /// Construct from a raw pointer.
     Reference(T* ptr) :
         ptr_(ptr)
@@ -99,6 +114,29 @@ public:
         return *this;
     }
 
+    /// Move-assign from another shared pointer.
+    Reference<T>& operator =(Reference<T>&& rhs) noexcept
+    {
+        T* ptr = rhs.ptr_;
+        rhs.ptr_ = 0;
+        releaseRef();
+        ptr_ = ptr;
+
+        return *this;
+    }
+
+    /// Move-assign from another shared pointer allowing implicit upcasting.
+    template <class U>
+    Reference<T>& operator =(Reference<U>&& rhs) noexcept
+    {
+        T* ptr = rhs.ptr_;
+        rhs.ptr_ = 0;
+        releaseRef();
+        ptr_ = ptr;
+
+        return *this;
+    }
+
     /// Assign from a raw pointer.
     Reference<T>& operator =(T* ptr)
     {
@@ -156,10 +194,8 @@ public:
     {
         if (ptr_)
         {
-            RefCount* refCount = refCountPtr();
-            ++refCount->refs_; // 2 refs
-            reset(); // 1 ref
-            --refCount->refs_; // 0 refs
+            refCountedPtr()->detachRef();
+            ptr_ = 0;
         }
     }
 
@@ -455,7 +491,7 @@ public:
     bool notNull() const { return refCount_ != 0; }
 
     /// Return the object's reference count, or 0 if null pointer or if object has expired.
-    int refs() const { return (refCount_ && refCount_->refs_ >= 0) ? refCount_->refs_ : 0; }
+    int refs() const { return expired() ? 0 : refCountedPtr()->refs(); }
 
     /// Return the object's weak reference count.
     int weakRefs() const
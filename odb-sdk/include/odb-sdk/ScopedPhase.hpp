@@ -0,0 +1,35 @@
+#pragma once
+
+#include "odb-sdk/MemReport.hpp"
+#include "odb-sdk/TimeReport.hpp"
+
+namespace odb {
+
+/*!
+ * @brief Marks one phase of a compilation. The phase is timed for the time
+ * report, and the memory report samples the peak RSS when it ends.
+ * @note The name has to outlive the phase, see ScopedTimer.
+ */
+class ScopedPhase
+{
+public:
+    explicit ScopedPhase(const char* name) :
+        timer_("phase", name),
+        name_(name)
+    {
+    }
+
+    ~ScopedPhase()
+    {
+        MemReport::recordPhase(name_);
+    }
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+private:
+    ScopedTimer timer_;
+    const char* name_;
+};
+
+}
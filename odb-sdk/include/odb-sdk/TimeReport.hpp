@@ -0,0 +1,103 @@
+#pragma once
+
+#include "odb-sdk/config.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace odb {
+
+/*!
+ * @brief Collects how long each phase of a compilation takes. Recording is
+ * off until enable() is called, until then timers only check a flag.
+ *
+ * Events are recorded from any thread. Each thread gets a small id in the
+ * order it records its first event, so phases that run in parallel show up
+ * side by side in the trace.
+ */
+class ODBSDK_PUBLIC_API TimeReport
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Event
+    {
+        const char* category;
+        std::string name;
+        //! Nanoseconds since enable() was called
+        std::int64_t start;
+        std::int64_t duration;
+        int threadId;
+    };
+
+    static void enable();
+    static void disable();
+    static bool enabled();
+
+    /*!
+     * @brief Discards all events and restarts the clock that event start
+     * times are measured from.
+     */
+    static void reset();
+
+    /*!
+     * @brief Records one finished event. Does nothing unless enabled.
+     * @param category Must be a string literal, it isn't copied.
+     */
+    static void addEvent(const char* category, std::string name, Clock::time_point start, Clock::time_point end);
+
+    //! Returns a copy of all events recorded so far, in the order they finished
+    static std::vector<Event> events();
+
+    /*!
+     * @brief Removes the events recorded by the calling thread and returns
+     * them. Events of other threads are kept.
+     */
+    static std::vector<Event> takeThreadEvents();
+
+    /*!
+     * @brief Prints the total time and count of each event to Log::info,
+     * grouped by category and sorted by total time. Only the slowest
+     * entries of long categories are printed.
+     */
+    static void printSummary();
+
+    /*!
+     * @brief Same as printSummary(), but only for the given events. The wall
+     * clock time is the time between the first and the last of them.
+     */
+    static void printSummary(const std::vector<Event>& events);
+
+    /*!
+     * @brief Writes all events as Chrome trace events, which can be opened
+     * with chrome://tracing or https://ui.perfetto.dev.
+     */
+    static void writeChromeTrace(FILE* fp);
+};
+
+/*!
+ * @brief Records the time between its construction and destruction as one
+ * event.
+ * @note The name isn't copied until the timer stops, so it has to stay
+ * alive for as long as the timer does.
+ */
+class ODBSDK_PUBLIC_API ScopedTimer
+{
+public:
+    ScopedTimer(const char* category, const char* name);
+    ScopedTimer(const char* category, const std::string& name);
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const char* category_;
+    const char* name_;
+    TimeReport::Clock::time_point start_;
+    bool active_;
+};
+
+}
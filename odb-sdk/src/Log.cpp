@@ -4,6 +4,20 @@
 
 namespace odb {
 
+namespace {
+struct ThreadRedirect
+{
+    FILE* stream = nullptr;
+    Log::Color color = Log::RESET;
+};
+
+ThreadRedirect& threadRedirect()
+{
+    static thread_local ThreadRedirect redirect;
+    return redirect;
+}
+}
+
 // ----------------------------------------------------------------------------
 Log::Log(FILE* stream) :
     stream_(stream)
@@ -18,20 +32,42 @@ Log::~Log()
 // ----------------------------------------------------------------------------
 FILE* Log::getStream() const
 {
-    return stream_;
+    return stream();
+}
+
+// ----------------------------------------------------------------------------
+FILE* Log::stream() const
+{
+    FILE* redirected = threadRedirect().stream;
+    return redirected ? redirected : stream_;
+}
+
+// ----------------------------------------------------------------------------
+Log::Color* Log::colorState()
+{
+    // A redirected thread tracks its own color, so it doesn't race with
+    // other threads writing to the same log
+    ThreadRedirect& redirect = threadRedirect();
+    return redirect.stream ? &redirect.color : &color_;
+}
+
+// ----------------------------------------------------------------------------
+void Log::redirectThread(FILE* stream)
+{
+    threadRedirect() = ThreadRedirect{stream, RESET};
 }
 
 // ----------------------------------------------------------------------------
 int Log::putc(char c)
 {
-    return ::putc(c, stream_);
+    return ::putc(c, stream());
 }
 
 // ----------------------------------------------------------------------------
 int Log::putc(Color color, char c)
 {
     ColorState state(*this, color);
-    return ::putc(c, stream_);
+    return ::putc(c, stream());
 }
 
 // ----------------------------------------------------------------------------
@@ -59,16 +95,18 @@ int Log::print(Color color, const char* fmt, ...)
 // ----------------------------------------------------------------------------
 int Log::vprint(const char* fmt, va_list ap)
 {
-    assert(stream_);
-    return vfprintf(stream_, fmt, ap);
+    FILE* stream = this->stream();
+    assert(stream);
+    return vfprintf(stream, fmt, ap);
 }
 
 // ----------------------------------------------------------------------------
 int Log::vprint(Color color, const char* fmt, va_list ap)
 {
-    assert(stream_);
+    FILE* stream = this->stream();
+    assert(stream);
     ColorState state(*this, color);
-    return vfprintf(stream_, fmt, ap);
+    return vfprintf(stream, fmt, ap);
 }
 
 // ----------------------------------------------------------------------------
@@ -277,9 +315,61 @@ int Log::vlogPrefixSeverity(const char* prefix, Log::Severity severity, const ch
 Log Log::info(stderr);
 Log Log::data(stdout);
 
+// ----------------------------------------------------------------------------
+ThreadLogBuffer::ThreadLogBuffer() :
+    file_(nullptr),
+    previousStream_(nullptr),
+    previousColor_(Log::RESET)
+{
+}
+
+// ----------------------------------------------------------------------------
+ThreadLogBuffer::~ThreadLogBuffer()
+{
+    if (file_)
+        std::fclose(file_);
+}
+
+// ----------------------------------------------------------------------------
+void ThreadLogBuffer::begin()
+{
+    // The calling thread may already be redirected, e.g. while the server
+    // compiles on it, so remember where its messages went before
+    previousStream_ = threadRedirect().stream;
+    previousColor_ = threadRedirect().color;
+
+    if (file_ == nullptr)
+        file_ = std::tmpfile();
+    if (file_)
+        threadRedirect() = ThreadRedirect{file_, Log::RESET};
+}
+
+// ----------------------------------------------------------------------------
+void ThreadLogBuffer::end()
+{
+    threadRedirect() = ThreadRedirect{previousStream_, previousColor_};
+}
+
+// ----------------------------------------------------------------------------
+void ThreadLogBuffer::flush(Log& log)
+{
+    if (file_ == nullptr)
+        return;
+
+    std::fflush(file_);
+    std::rewind(file_);
+    char buffer[4096];
+    std::size_t bytesRead;
+    while ((bytesRead = std::fread(buffer, 1, sizeof(buffer), file_)) > 0)
+        std::fwrite(buffer, 1, bytesRead, log.getStream());
+
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
 // ----------------------------------------------------------------------------
 ColorState::ColorState(Log& log, Log::Color color) :
-    log_(log), saveColor_(log.color_)
+    log_(log), saveColor_(*log.colorState())
 {
     apply(log_, color);
 }
@@ -293,7 +383,7 @@ ColorState::~ColorState()
 // ----------------------------------------------------------------------------
 void ColorState::apply(Log& log, Log::Color color)
 {
-    log.color_ = color;
+    *log.colorState() = color;
 
     if (log.enableColor_ == false)
         return;
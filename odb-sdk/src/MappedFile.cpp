@@ -0,0 +1,230 @@
+#include "odb-sdk/MappedFile.hpp"
+
+#if defined(ODBSDK_PLATFORM_LINUX) || defined(ODBSDK_PLATFORM_MACOS)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#elif defined(ODBSDK_PLATFORM_WIN32)
+#   define WIN32_LEAN_AND_MEAN
+#   include <Windows.h>
+#else
+#   error "Platform not supported"
+#endif
+
+namespace odb {
+
+struct MappedFilePlatformData
+{
+    char* address = nullptr;
+    std::size_t size = 0;
+    bool writable = false;
+#if defined(ODBSDK_PLATFORM_LINUX) || defined(ODBSDK_PLATFORM_MACOS)
+    std::size_t mappedSize = 0;
+#elif defined(ODBSDK_PLATFORM_WIN32)
+    HANDLE mapping = nullptr;
+    std::unique_ptr<char[]> buffer;
+#endif
+};
+
+// ----------------------------------------------------------------------------
+MappedFile* MappedFile::open(const char* filename)
+{
+    auto data = std::make_unique<MappedFilePlatformData>();
+
+#if defined(ODBSDK_PLATFORM_LINUX) || defined(ODBSDK_PLATFORM_MACOS)
+    int fd = ::open(filename, O_RDONLY);
+    if (fd == -1)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    // mmap() doesn't accept a length of 0
+    data->size = static_cast<std::size_t>(st.st_size);
+    if (data->size > 0)
+    {
+        void* address = mmap(nullptr, data->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED)
+        {
+            close(fd);
+            return nullptr;
+        }
+        data->address = static_cast<char*>(address);
+        data->mappedSize = data->size;
+    }
+
+    // The mapping keeps its own reference to the file
+    close(fd);
+#elif defined(ODBSDK_PLATFORM_WIN32)
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    // CreateFileMapping() doesn't accept empty files
+    data->size = static_cast<std::size_t>(size.QuadPart);
+    if (data->size > 0)
+    {
+        data->mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (data->mapping == nullptr)
+        {
+            CloseHandle(file);
+            return nullptr;
+        }
+
+        data->address = static_cast<char*>(MapViewOfFile(data->mapping, FILE_MAP_READ, 0, 0, 0));
+        if (data->address == nullptr)
+        {
+            CloseHandle(data->mapping);
+            CloseHandle(file);
+            return nullptr;
+        }
+    }
+
+    // The mapping keeps its own reference to the file
+    CloseHandle(file);
+#endif
+
+    return new MappedFile(std::move(data), filename);
+}
+
+// ----------------------------------------------------------------------------
+MappedFile* MappedFile::openPrivate(const char* filename, std::size_t zeroPadding)
+{
+    auto data = std::make_unique<MappedFilePlatformData>();
+    data->writable = true;
+
+#if defined(ODBSDK_PLATFORM_LINUX) || defined(ODBSDK_PLATFORM_MACOS)
+    int fd = ::open(filename, O_RDONLY);
+    if (fd == -1)
+        return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    // Reserve enough zeroed pages for the file and its padding, then map the
+    // file over the start of the reservation. The rest of the file's last
+    // page is zero filled by the kernel, and the pages after it are the
+    // zeroed anonymous pages.
+    const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    data->size = static_cast<std::size_t>(st.st_size);
+    data->mappedSize = (data->size + zeroPadding + pageSize - 1) / pageSize * pageSize;
+    if (data->mappedSize == 0)
+        data->mappedSize = pageSize;
+
+    void* address = mmap(nullptr, data->mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (address == MAP_FAILED)
+    {
+        close(fd);
+        return nullptr;
+    }
+    data->address = static_cast<char*>(address);
+
+    if (data->size > 0 &&
+        mmap(address, data->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        munmap(address, data->mappedSize);
+        close(fd);
+        return nullptr;
+    }
+
+    // The mapping keeps its own reference to the file
+    close(fd);
+#elif defined(ODBSDK_PLATFORM_WIN32)
+    // Views can't extend past the end of the file on Windows, so the file is
+    // read into a zero padded buffer instead
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return nullptr;
+    }
+
+    data->size = static_cast<std::size_t>(size.QuadPart);
+    data->buffer.reset(new char[data->size + zeroPadding]());
+    data->address = data->buffer.get();
+    for (std::size_t offset = 0; offset < data->size;)
+    {
+        DWORD bytesRead;
+        DWORD chunk = static_cast<DWORD>(data->size - offset < 0x40000000 ? data->size - offset : 0x40000000);
+        if (!ReadFile(file, data->address + offset, chunk, &bytesRead, nullptr) || bytesRead == 0)
+        {
+            CloseHandle(file);
+            return nullptr;
+        }
+        offset += bytesRead;
+    }
+
+    CloseHandle(file);
+#endif
+
+    return new MappedFile(std::move(data), filename);
+}
+
+// ----------------------------------------------------------------------------
+MappedFile::MappedFile(std::unique_ptr<MappedFilePlatformData> data, const std::string& filename)
+    : data_(std::move(data)), filename_(filename)
+{
+}
+
+// ----------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{
+#if defined(ODBSDK_PLATFORM_LINUX) || defined(ODBSDK_PLATFORM_MACOS)
+    if (data_->address)
+        munmap(data_->address, data_->mappedSize);
+#elif defined(ODBSDK_PLATFORM_WIN32)
+    if (data_->mapping)
+    {
+        UnmapViewOfFile(data_->address);
+        CloseHandle(data_->mapping);
+    }
+#endif
+}
+
+// ----------------------------------------------------------------------------
+const char* MappedFile::getFilename() const
+{
+    return filename_.c_str();
+}
+
+// ----------------------------------------------------------------------------
+const char* MappedFile::data() const
+{
+    return data_->address;
+}
+
+// ----------------------------------------------------------------------------
+char* MappedFile::writableData()
+{
+    return data_->writable ? data_->address : nullptr;
+}
+
+// ----------------------------------------------------------------------------
+std::size_t MappedFile::size() const
+{
+    return data_->size;
+}
+
+}
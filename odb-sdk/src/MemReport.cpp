@@ -0,0 +1,307 @@
+#include "odb-sdk/MemReport.hpp"
+#include "odb-sdk/Log.hpp"
+#include <algorithm>
+#include <mutex>
+
+#if defined(ODBSDK_PLATFORM_WIN32)
+#   include <Windows.h>
+#   include <psapi.h>
+#else
+#   include <sys/resource.h>
+#endif
+
+namespace odb {
+
+namespace {
+struct Counters
+{
+    std::atomic<std::int64_t> created{0};
+    std::atomic<std::int64_t> createdBytes{0};
+    std::atomic<std::int64_t> live{0};
+    std::atomic<std::int64_t> liveBytes{0};
+    std::atomic<std::int64_t> peakLive{0};
+    std::atomic<std::int64_t> peakLiveBytes{0};
+};
+
+struct Recorder
+{
+    Counters counters[(int)MemCategory::Count];
+    std::mutex mutex;
+    std::vector<MemReport::Phase> phases;
+};
+
+Recorder& recorder()
+{
+    static Recorder recorder;
+    return recorder;
+}
+
+void updatePeak(std::atomic<std::int64_t>& peak, std::int64_t value)
+{
+    std::int64_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed))
+    {}
+}
+
+// Objects that were created before counting was enabled or reset are still
+// untracked when they are destroyed. Their frees are clamped so the live
+// counts never go negative.
+std::int64_t addClamped(std::atomic<std::int64_t>& value, std::int64_t delta)
+{
+    std::int64_t current = value.load(std::memory_order_relaxed);
+    std::int64_t next;
+    do
+    {
+        next = std::max<std::int64_t>(0, current + delta);
+    } while (!value.compare_exchange_weak(current, next, std::memory_order_relaxed));
+    return next;
+}
+
+bool hasBytes(MemCategory category)
+{
+    return category != MemCategory::RefCounted;
+}
+
+bool hasLifetime(MemCategory category)
+{
+    return category != MemCategory::LLVMInstruction;
+}
+
+// The memory of these is already part of another category: AST nodes and
+// locations live in arena chunks, and variables are counted as IR nodes too
+bool isNested(MemCategory category)
+{
+    return category == MemCategory::ASTNode
+        || category == MemCategory::SourceLocation
+        || category == MemCategory::IRVariable;
+}
+}
+
+std::atomic<bool> MemReport::enabled_{false};
+
+// ----------------------------------------------------------------------------
+void MemReport::enable()
+{
+    enabled_ = true;
+}
+
+// ----------------------------------------------------------------------------
+void MemReport::disable()
+{
+    enabled_ = false;
+}
+
+// ----------------------------------------------------------------------------
+void MemReport::reset()
+{
+    Recorder& r = recorder();
+    for (Counters& c : r.counters)
+    {
+        c.created = 0;
+        c.createdBytes = 0;
+        c.live = 0;
+        c.liveBytes = 0;
+        c.peakLive = 0;
+        c.peakLiveBytes = 0;
+    }
+
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.phases.clear();
+}
+
+// ----------------------------------------------------------------------------
+void MemReport::add(MemCategory category, std::int64_t count, std::int64_t bytes)
+{
+    Counters& c = recorder().counters[(int)category];
+    if (count > 0)
+    {
+        c.created.fetch_add(count, std::memory_order_relaxed);
+        c.createdBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    updatePeak(c.peakLive, addClamped(c.live, count));
+    updatePeak(c.peakLiveBytes, addClamped(c.liveBytes, bytes));
+}
+
+// ----------------------------------------------------------------------------
+void MemReport::addCreated(MemCategory category, std::size_t count, std::size_t bytes)
+{
+    if (!enabled())
+        return;
+
+    Counters& c = recorder().counters[(int)category];
+    c.created.fetch_add((std::int64_t)count, std::memory_order_relaxed);
+    c.createdBytes.fetch_add((std::int64_t)bytes, std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+void MemReport::recordPhase(const char* name)
+{
+    if (!enabled())
+        return;
+
+    std::int64_t trackedBytes = 0;
+    for (int i = 0; i != (int)MemCategory::Count; ++i)
+        if (!isNested((MemCategory)i))
+            trackedBytes += recorder().counters[i].liveBytes.load(std::memory_order_relaxed);
+
+    Recorder& r = recorder();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.phases.push_back({name, peakRSS(), trackedBytes});
+}
+
+// ----------------------------------------------------------------------------
+MemReport::Stats MemReport::stats(MemCategory category)
+{
+    const Counters& c = recorder().counters[(int)category];
+    return {
+        c.created.load(std::memory_order_relaxed),
+        c.createdBytes.load(std::memory_order_relaxed),
+        c.live.load(std::memory_order_relaxed),
+        c.liveBytes.load(std::memory_order_relaxed),
+        c.peakLive.load(std::memory_order_relaxed),
+        c.peakLiveBytes.load(std::memory_order_relaxed)
+    };
+}
+
+// ----------------------------------------------------------------------------
+std::vector<MemReport::Phase> MemReport::phases()
+{
+    Recorder& r = recorder();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.phases;
+}
+
+// ----------------------------------------------------------------------------
+const char* MemReport::categoryName(MemCategory category)
+{
+    switch (category)
+    {
+        case MemCategory::RefCounted      : return "RefCounted";
+        case MemCategory::ASTNode         : return "ASTNode";
+        case MemCategory::SourceLocation  : return "SourceLocation";
+        case MemCategory::ASTArena        : return "ASTArena";
+        case MemCategory::IRNode          : return "IRNode";
+        case MemCategory::IRVariable      : return "IRVariable";
+        case MemCategory::LLVMInstruction : return "LLVMInstruction";
+        case MemCategory::Count           : break;
+    }
+
+    return "";
+}
+
+// ----------------------------------------------------------------------------
+std::size_t MemReport::peakRSS()
+{
+#if defined(ODBSDK_PLATFORM_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#   if defined(ODBSDK_PLATFORM_MACOS)
+    return (std::size_t)usage.ru_maxrss;
+#   else
+    return (std::size_t)usage.ru_maxrss * 1024;
+#   endif
+#endif
+}
+
+// ----------------------------------------------------------------------------
+void MemReport::printSummary()
+{
+    auto printCount = [](bool valid, std::int64_t value) {
+        if (valid)
+            Log::info.print(" %12lld", (long long)value);
+        else
+            Log::info.print(" %12s", "-");
+    };
+    auto printBytes = [](bool valid, std::int64_t value) {
+        if (valid)
+            Log::info.print(" %11.1f KB", value / 1024.0);
+        else
+            Log::info.print(" %14s", "-");
+    };
+
+    Log::info.print(Log::FG_BRIGHT_WHITE, "Memory report");
+    Log::info.print(" (peak RSS %.1f KB)\n", peakRSS() / 1024.0);
+    Log::info.print(Log::FG_BRIGHT_YELLOW, "  %-16s %12s %14s %12s %14s %12s %14s",
+        "category", "created", "created bytes", "peak live", "peak bytes", "live", "live bytes");
+    Log::info.print("\n");
+    for (int i = 0; i != (int)MemCategory::Count; ++i)
+    {
+        MemCategory category = (MemCategory)i;
+        Stats s = stats(category);
+        bool bytes = hasBytes(category);
+        bool lifetime = hasLifetime(category);
+
+        Log::info.print("  %-16s", categoryName(category));
+        printCount(true, s.created);
+        printBytes(bytes, s.createdBytes);
+        printCount(lifetime, s.peakLive);
+        printBytes(bytes && lifetime, s.peakLiveBytes);
+        printCount(lifetime, s.live);
+        printBytes(bytes && lifetime, s.liveBytes);
+        Log::info.print("\n");
+    }
+
+    Log::info.print(Log::FG_BRIGHT_YELLOW, "  %-24s %14s %14s", "end of phase", "peak RSS", "tracked bytes");
+    Log::info.print("\n");
+    for (const Phase& phase : phases())
+    {
+        Log::info.print("  %-24s %11.1f KB %11.1f KB\n",
+            phase.name.c_str(),
+            phase.peakRSS / 1024.0,
+            phase.trackedBytes / 1024.0);
+    }
+}
+
+// ----------------------------------------------------------------------------
+void MemReport::writeJSON(FILE* fp)
+{
+    auto writeValue = [fp](const char* key, bool valid, std::int64_t value) {
+        if (valid)
+            std::fprintf(fp, "\"%s\":%lld", key, (long long)value);
+        else
+            std::fprintf(fp, "\"%s\":null", key);
+    };
+
+    std::fprintf(fp, "{\"peakRSS\":%zu,\"categories\":{", peakRSS());
+    for (int i = 0; i != (int)MemCategory::Count; ++i)
+    {
+        MemCategory category = (MemCategory)i;
+        Stats s = stats(category);
+        bool bytes = hasBytes(category);
+        bool lifetime = hasLifetime(category);
+
+        // Category names are identifiers and need no escaping
+        std::fprintf(fp, "%s\n\"%s\":{", i == 0 ? "" : ",", categoryName(category));
+        writeValue("created", true, s.created);
+        std::fputc(',', fp);
+        writeValue("createdBytes", bytes, s.createdBytes);
+        std::fputc(',', fp);
+        writeValue("peakLive", lifetime, s.peakLive);
+        std::fputc(',', fp);
+        writeValue("peakLiveBytes", bytes && lifetime, s.peakLiveBytes);
+        std::fputc(',', fp);
+        writeValue("live", lifetime, s.live);
+        std::fputc(',', fp);
+        writeValue("liveBytes", bytes && lifetime, s.liveBytes);
+        std::fputc('}', fp);
+    }
+
+    // Phase names are identifiers as well
+    std::fputs("},\n\"phases\":[", fp);
+    bool first = true;
+    for (const Phase& phase : phases())
+    {
+        std::fprintf(fp, "%s\n{\"name\":\"%s\",\"peakRSS\":%zu,\"trackedBytes\":%lld}",
+            first ? "" : ",", phase.name.c_str(), phase.peakRSS, (long long)phase.trackedBytes);
+        first = false;
+    }
+    std::fputs("\n]}\n", fp);
+}
+
+}
@@ -21,63 +21,88 @@
 //
 
 #include "odb-sdk/RefCounted.hpp"
+#include "odb-sdk/MemReport.hpp"
 
 #include <cassert>
-#include <map>
 
 namespace odb {
 
 // ----------------------------------------------------------------------------
-RefCounted::RefCounted() :
-    refCount_(new RefCount())
+RefCounted::RefCounted(RefCountPolicy policy) :
+    refs_(0),
+    policy_(policy),
+    refCount_(nullptr)
 {
-    // Hold a weak ref to self to avoid possible double delete of the refcount
-    (refCount_->weakRefs_)++;
+    MemReport::track(MemCategory::RefCounted, 0);
 }
 
 // ----------------------------------------------------------------------------
 RefCounted::~RefCounted()
 {
-    assert(refCount_);
-    assert(refCount_->refs_ == 0);
-    assert(refCount_->weakRefs_ > 0);
+    assert(refs() == 0);
+    MemReport::untrack(MemCategory::RefCounted, 0);
 
     // Mark object as expired, release the self weak ref and delete the refcount if no other weak refs exist
-    refCount_->refs_ = -1;
-    (refCount_->weakRefs_)--;
-    if (!refCount_->weakRefs_)
-        delete refCount_;
+    refs_.store(-1, std::memory_order_relaxed);
+    if (refCount_)
+    {
+        assert(refCount_->weakRefs_ > 0);
+        refCount_->refs_ = -1;
+        (refCount_->weakRefs_)--;
+        if (!refCount_->weakRefs_)
+            delete refCount_;
 
-    refCount_ = 0;
+        refCount_ = nullptr;
+    }
 }
 
 // ----------------------------------------------------------------------------
-void RefCounted::addRef()
+void RefCounted::releaseRef()
 {
-    assert(refCount_->refs_ >= 0);
-    (refCount_->refs_)++;
+    if (!decrementRefs())
+        delete this;
 }
 
 // ----------------------------------------------------------------------------
-void RefCounted::releaseRef()
+void RefCounted::detachRef()
 {
-    assert(refCount_->refs_ > 0);
-    (refCount_->refs_)--;
-    if (!refCount_->refs_)
-        delete this;
+    decrementRefs();
 }
 
 // ----------------------------------------------------------------------------
-int RefCounted::refs() const
+int RefCounted::decrementRefs()
 {
-    return refCount_->refs_;
+    assert(refs() > 0);
+
+    // The last release has to observe all writes made to the object through
+    // other references before it is deleted, hence acq_rel
+    if (policy_ == RefCountPolicy::ThreadSafe)
+        return refs_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+
+    int refs = refs_.load(std::memory_order_relaxed) - 1;
+    refs_.store(refs, std::memory_order_relaxed);
+    return refs;
 }
 
 // ----------------------------------------------------------------------------
 int RefCounted::weakRefs() const
 {
     // Subtract one to not return the internally held reference
-    return refCount_->weakRefs_ - 1;
+    return refCount_ ? refCount_->weakRefs_ - 1 : 0;
+}
+
+// ----------------------------------------------------------------------------
+RefCount* RefCounted::refCountPtr()
+{
+    if (!refCount_)
+    {
+        refCount_ = new RefCount();
+
+        // Hold a weak ref to self to avoid possible double delete of the refcount
+        (refCount_->weakRefs_)++;
+    }
+
+    return refCount_;
 }
 
 }
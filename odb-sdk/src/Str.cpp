@@ -81,7 +81,7 @@ std::string escape(const std::string& s)
 // ----------------------------------------------------------------------------
 void toLowerInplace(std::string& str)
 {
-    std::transform(str.begin(), str.end(), str.begin(), [](char c){ return std::tolower(c); });
+    std::transform(str.begin(), str.end(), str.begin(), [](char c){ return (char)std::tolower((unsigned char)c); });
 }
 
 // ----------------------------------------------------------------------------
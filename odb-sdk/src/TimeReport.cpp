@@ -0,0 +1,262 @@
+#include "odb-sdk/TimeReport.hpp"
+#include "odb-sdk/Log.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
+
+namespace odb {
+
+namespace {
+struct Recorder
+{
+    std::atomic<bool> enabled = false;
+    std::atomic<int> nextThreadId = 1;
+    TimeReport::Clock::time_point epoch;
+    std::mutex mutex;
+    std::vector<TimeReport::Event> events;
+};
+
+Recorder& recorder()
+{
+    static Recorder recorder;
+    return recorder;
+}
+
+int currentThreadId()
+{
+    static thread_local int id = recorder().nextThreadId++;
+    return id;
+}
+
+std::int64_t nanoseconds(TimeReport::Clock::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+
+void printEvents(const std::vector<TimeReport::Event>& events, std::int64_t wallTime)
+{
+    struct Entry
+    {
+        const std::string* name;
+        std::int64_t total = 0;
+        int count = 0;
+    };
+    struct Category
+    {
+        std::string name;
+        std::vector<Entry> entries;
+        std::unordered_map<std::string, std::size_t> index;
+    };
+
+    const std::size_t maxEntries = 15;
+
+    // Keep categories in the order they first appeared, which roughly
+    // follows the order of the phases
+    std::vector<Category> categories;
+    for (const TimeReport::Event& event : events)
+    {
+        auto category = std::find_if(categories.begin(), categories.end(),
+            [&event](const Category& c) { return c.name == event.category; });
+        if (category == categories.end())
+        {
+            categories.push_back({event.category, {}, {}});
+            category = categories.end() - 1;
+        }
+
+        auto [it, inserted] = category->index.try_emplace(event.name, category->entries.size());
+        if (inserted)
+            category->entries.push_back({&it->first});
+
+        Entry& entry = category->entries[it->second];
+        entry.total += event.duration;
+        entry.count++;
+    }
+
+    Log::info.print(Log::FG_BRIGHT_WHITE, "Time report");
+    Log::info.print(" (%.3f ms wall clock)\n", wallTime / 1e6);
+    for (Category& category : categories)
+    {
+        std::stable_sort(category.entries.begin(), category.entries.end(),
+            [](const Entry& a, const Entry& b) { return a.total > b.total; });
+
+        Log::info.print(Log::FG_BRIGHT_YELLOW, "  %s", category.name.c_str());
+        Log::info.print("\n");
+        std::size_t shown = std::min(category.entries.size(), maxEntries);
+        for (std::size_t i = 0; i != shown; ++i)
+        {
+            const Entry& entry = category.entries[i];
+            Log::info.print("    %10.3f ms %6.1f%% %6dx  %s\n",
+                entry.total / 1e6,
+                wallTime > 0 ? 100.0 * entry.total / wallTime : 0.0,
+                entry.count,
+                entry.name->c_str());
+        }
+        if (category.entries.size() > shown)
+            Log::info.print("    ... %d more\n", (int)(category.entries.size() - shown));
+    }
+}
+
+void writeJSONString(FILE* fp, const std::string& str)
+{
+    std::fputc('"', fp);
+    for (char c : str)
+    {
+        switch (c)
+        {
+            case '"'  : std::fputs("\\\"", fp); break;
+            case '\\' : std::fputs("\\\\", fp); break;
+            case '\n' : std::fputs("\\n", fp); break;
+            case '\t' : std::fputs("\\t", fp); break;
+            default:
+                if ((unsigned char)c < 0x20)
+                    std::fprintf(fp, "\\u%04x", c);
+                else
+                    std::fputc(c, fp);
+                break;
+        }
+    }
+    std::fputc('"', fp);
+}
+}
+
+// ----------------------------------------------------------------------------
+void TimeReport::enable()
+{
+    Recorder& r = recorder();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if (r.enabled)
+        return;
+
+    r.epoch = Clock::now();
+    r.enabled = true;
+}
+
+// ----------------------------------------------------------------------------
+void TimeReport::disable()
+{
+    recorder().enabled = false;
+}
+
+// ----------------------------------------------------------------------------
+void TimeReport::reset()
+{
+    Recorder& r = recorder();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.events.clear();
+    r.epoch = Clock::now();
+}
+
+// ----------------------------------------------------------------------------
+bool TimeReport::enabled()
+{
+    return recorder().enabled.load(std::memory_order_relaxed);
+}
+
+// ----------------------------------------------------------------------------
+void TimeReport::addEvent(const char* category, std::string name, Clock::time_point start, Clock::time_point end)
+{
+    if (!enabled())
+        return;
+
+    int threadId = currentThreadId();
+    Recorder& r = recorder();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.events.push_back({category, std::move(name), nanoseconds(start - r.epoch), nanoseconds(end - start), threadId});
+}
+
+// ----------------------------------------------------------------------------
+std::vector<TimeReport::Event> TimeReport::events()
+{
+    Recorder& r = recorder();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.events;
+}
+
+// ----------------------------------------------------------------------------
+std::vector<TimeReport::Event> TimeReport::takeThreadEvents()
+{
+    int threadId = currentThreadId();
+    Recorder& r = recorder();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    std::vector<Event> taken;
+    auto kept = std::stable_partition(r.events.begin(), r.events.end(),
+        [threadId](const Event& event) { return event.threadId != threadId; });
+    taken.assign(std::make_move_iterator(kept), std::make_move_iterator(r.events.end()));
+    r.events.erase(kept, r.events.end());
+    return taken;
+}
+
+// ----------------------------------------------------------------------------
+void TimeReport::printSummary()
+{
+    Recorder& r = recorder();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    printEvents(r.events, nanoseconds(Clock::now() - r.epoch));
+}
+
+// ----------------------------------------------------------------------------
+void TimeReport::printSummary(const std::vector<Event>& events)
+{
+    std::int64_t first = events.empty() ? 0 : events.front().start;
+    std::int64_t last = first;
+    for (const Event& event : events)
+    {
+        first = std::min(first, event.start);
+        last = std::max(last, event.start + event.duration);
+    }
+
+    printEvents(events, last - first);
+}
+
+// ----------------------------------------------------------------------------
+void TimeReport::writeChromeTrace(FILE* fp)
+{
+    Recorder& r = recorder();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", fp);
+    int threadCount = r.nextThreadId.load() - 1;
+    for (int tid = 1; tid <= threadCount; ++tid)
+    {
+        std::fprintf(fp, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+            tid == 1 ? "" : ",", tid, tid);
+    }
+    for (const Event& event : r.events)
+    {
+        std::fputs(",\n{\"name\":", fp);
+        writeJSONString(fp, event.name);
+        std::fputs(",\"cat\":", fp);
+        writeJSONString(fp, event.category);
+        std::fprintf(fp, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+            event.start / 1000.0, event.duration / 1000.0, event.threadId);
+    }
+    std::fputs("\n]}\n", fp);
+}
+
+// ----------------------------------------------------------------------------
+ScopedTimer::ScopedTimer(const char* category, const char* name) :
+    category_(category),
+    name_(name),
+    active_(TimeReport::enabled())
+{
+    if (active_)
+        start_ = TimeReport::Clock::now();
+}
+
+// ----------------------------------------------------------------------------
+ScopedTimer::ScopedTimer(const char* category, const std::string& name) :
+    ScopedTimer(category, name.c_str())
+{
+}
+
+// ----------------------------------------------------------------------------
+ScopedTimer::~ScopedTimer()
+{
+    if (active_)
+        TimeReport::addEvent(category_, name_, start_, TimeReport::Clock::now());
+}
+
+}
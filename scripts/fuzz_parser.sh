@@ -0,0 +1,10 @@
+#!/bin/bash
+
+TESTCASES=../../afl/testcases
+DICTIONARY=../../afl/dictionary/dbp.dict
+CORPUS=fuzz-corpus
+FUZZER=./odbc_fuzz
+
+# New inputs are written to the first directory, the test cases are only read
+mkdir -p "$CORPUS"
+"$FUZZER" -dict="$DICTIONARY" -jobs=$(nproc) -workers=$(nproc) "$@" "$CORPUS" "$TESTCASES"